@@ -0,0 +1,246 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#include "construction.h"
+#include "crossover.h"
+#include "cvrp.h"
+#include "fitness.h"
+#include "kernels.h"
+#include "local_search.h"
+#include "gene.h"
+#include "node.h"
+#include "problem_instance.h"
+#include "random.h"
+#include "selection.h"
+#include "stopping.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// usage:
+//   cvrp_bench micro instance.vrp [--min-time S]
+//     time the hot kernels on one instance
+//   cvrp_bench macro instances.txt [--seeds 1,2,3] [--time S] [--islands N] [--local-search N] [--selection S] [--tournament K]
+//     solve every listed instance per seed under a time budget
+//     local search budget as in main, negative runs the plain GA
+// both modes print one JSON document to stdout
+
+// exposes the full cost recomputation that cost() normally caches
+struct BenchGene : public Gene {
+    BenchGene(const Gene &gene): Gene(gene) {}
+    void recompute() { update(); }
+    const Node *nodes() const { return nodes_.data(); }
+    int size() const { return nodes_.size(); }
+};
+
+// exposes the population for repeated selection and sorting
+struct BenchCVRP : public CVRP {
+    BenchCVRP(shared_ptr<const ProblemInstance> instance): CVRP(instance, 120, 1000000, 0.75, 0.15, 5000) {}
+    const Gene &gene(int i) const { return genes_[i]; }
+    int size() const { return genes_.size(); }
+    void evaluate() { Gene::evaluate(genes_.data(), genes_.size()); }
+    // what evaluate() does when every gene changed, scored genes are skipped there
+    void rescore() {
+        static vector<const Node*> paths;
+        static vector<int> sizes;
+        static vector<double> costs;
+        paths.clear();
+        sizes.clear();
+        for (int k = 0; k < genes_.size(); ++k) {
+            paths.push_back(genes_[k].nodes().data());
+            sizes.push_back(genes_[k].nodes().size());
+        }
+        costs.resize(genes_.size());
+        Fitness::costs(instance_->distances(), paths.data(), sizes.data(), genes_.size(), costs.data());
+    }
+};
+
+static double elapsedSince(steady_clock::time_point start) {
+    return duration_cast< duration<double> >(steady_clock::now() - start).count();
+}
+
+// run the kernel in doubling batches until a batch lasts minTime
+template <typename Kernel>
+static void timeKernel(const char *name, Kernel kernel, double minTime, bool &first) {
+    long iterations = 1;
+    double elapsed = 0;
+    for (;;) {
+        steady_clock::time_point start = steady_clock::now();
+        for (long i = 0; i < iterations; ++i) kernel();
+        elapsed = elapsedSince(start);
+        if (elapsed >= minTime) break;
+        iterations *= 2;
+    }
+    printf("%s\n    {\"name\": \"%s\", \"iterations\": %ld, \"ns_per_op\": %.1f}", first ? "" : ",", name, iterations, elapsed * 1e9 / iterations);
+    first = false;
+    fflush(stdout);
+}
+
+static int runMicro(const char *path, double minTime) {
+    Random::seed(1);
+    shared_ptr<const ProblemInstance> instance = ProblemInstance::load(path);
+    BenchCVRP cvrp(instance);
+    cvrp.generateGenes();
+
+    // an unchopped tour for chop()
+    vector<Node> tour;
+    for (int i = 2; i <= instance->dimension(); ++i) tour.push_back(Node(i));
+    const Gene unchopped(instance.get(), tour);
+
+    const Gene &a = cvrp.gene(0), &b = cvrp.gene(1);
+    BenchGene scratch(a);
+    Gene work(a), mutated(a);
+    volatile double sink = 0;
+    bool first = true;
+
+    printf("{\n  \"mode\": \"micro\",\n  \"instance\": \"%s\",\n  \"dimension\": %d,\n  \"distance_bytes\": %zu,\n  \"initial_best_cost\": %.3f,\n  \"fitness_kernel\": \"%s\",\n  \"kernel_shape\": \"%s\",\n  \"micro\": [", path, instance->dimension(), instance->distances().bytes(), cvrp.gene(0).cost(), Fitness::name(Fitness::kernel()), Kernels::name(Kernels::shape(*instance)));
+    timeKernel("ProblemInstance::load", [&]() { sink = ProblemInstance::load(path)->capacity(); }, minTime, first);
+    timeKernel("Gene::cost", [&]() { scratch.recompute(); sink = scratch.cost(); }, minTime, first);
+    // every fitness kernel the CPU runs, on the same chopped gene
+    const Fitness::Kernel kernels[] = { Fitness::SCALAR, Fitness::AVX2, Fitness::AVX512 };
+    for (int k = 0; k < 3; ++k) {
+        if (!Fitness::supported(kernels[k])) continue;
+        string name = string("Fitness::cost ") + Fitness::name(kernels[k]);
+        timeKernel(name.c_str(), [&]() { sink = Fitness::cost(kernels[k], instance->distances(), scratch.nodes(), scratch.size()); }, minTime, first);
+    }
+    // the same gene over distances computed from the coordinates
+    shared_ptr<const ProblemInstance> computed = ProblemInstance::load(path, 20, 0);
+    if (computed->distances().layout() == DistanceMatrix::ON_DEMAND) {
+        timeKernel("ProblemInstance::load on demand", [&]() { sink = ProblemInstance::load(path, 20, 0)->capacity(); }, minTime, first);
+        for (int k = 0; k < 3; ++k) {
+            if (!Fitness::supported(kernels[k])) continue;
+            string name = string("Fitness::cost on demand ") + Fitness::name(kernels[k]);
+            timeKernel(name.c_str(), [&]() { sink = Fitness::cost(kernels[k], computed->distances(), scratch.nodes(), scratch.size()); }, minTime, first);
+        }
+    }
+    // the population is scored, this only finds nothing changed
+    timeKernel("Gene::evaluate unchanged", [&]() { cvrp.evaluate(); }, minTime, first);
+    timeKernel("Gene::evaluate all changed", [&]() { cvrp.rescore(); }, minTime, first);
+    const Crossover rbx(Crossover::RBX), ox(Crossover::OX), erx(Crossover::ERX);
+    timeKernel("Crossover::RBX", [&]() { rbx(a, b, work); sink = work.cost(); }, minTime, first);
+    timeKernel("Crossover::OX", [&]() { ox(a, b, work); sink = work.cost(); }, minTime, first);
+    timeKernel("Crossover::ERX", [&]() { erx(a, b, work); sink = work.cost(); }, minTime, first);
+    Gene child;
+    rbx(a, b, child);
+    const LocalSearch descent;
+    // every kernel shape the instance allows, on the same child
+    for (int k = Kernels::WIDE; k <= Kernels::shape(*instance); ++k) {
+        string name = string("LocalSearch ") + Kernels::name((Kernels::Shape)k);
+        timeKernel(name.c_str(), [&]() { work = child; sink = descent(work, (Kernels::Shape)k); }, minTime, first);
+    }
+    timeKernel("Gene::chop", [&]() { work = unchopped; work.chop(); sink = work.cost(); }, minTime, first);
+    work = a;
+    timeKernel("Gene::validate", [&]() { sink = work.validate(); }, minTime, first);
+    timeKernel("Gene::sequentialMutate", [&]() { mutated.sequentialMutate(1.0, 5000); }, minTime, first);
+    timeKernel("Gene::optMutation", [&]() { mutated.optMutation(1.0); }, minTime, first);
+    vector<Node> constructed;
+    const Construction::Type constructions[] = { Construction::SAVINGS, Construction::SWEEP, Construction::NEAREST };
+    for (int k = 0; k < 3; ++k) {
+        string name = string("Construction::") + Construction::name(constructions[k]);
+        timeKernel(name.c_str(), [&]() { Construction::build(constructions[k], *instance, constructed); sink = constructed.size(); }, minTime, first);
+    }
+    timeKernel("CVRP::generateGenes", [&]() { BenchCVRP fresh(instance); fresh.generateGenes(); sink = fresh.gene(0).cost(); }, minTime, first);
+    timeKernel("CVRP::selectByCost", [&]() { sink = cvrp.selectByCost().size(); }, minTime, first);
+    timeKernel("CVRP::sortByCost", [&]() { cvrp.sortByCost(); }, minTime, first);
+    printf("\n  ]\n}\n");
+    return 0;
+}
+
+static int runMacro(const char *manifest, const vector<unsigned long long> &seeds, double timeBudget, int islands, int localSearch, const Selection &selection) {
+    // instance paths are relative to the manifest
+    string dir(manifest);
+    size_t slash = dir.find_last_of('/');
+    dir = (slash == string::npos)? "" : dir.substr(0, slash + 1);
+
+    ifstream file(manifest);
+    string line;
+    bool first = true;
+
+    printf("{\n  \"mode\": \"macro\",\n  \"time_budget\": %.3f,\n  \"islands\": %d,\n  \"local_search\": %d,\n  \"selection\": \"%s\",\n  \"runs\": [", timeBudget, islands, localSearch, Selection::name(selection.type()));
+    while (getline(file, line)) {
+        istringstream fields(line);
+        string path;
+        double reference = 0;
+        if (!(fields >> path) || path[0] == '#') continue;
+        fields >> reference;
+        path = dir + path;
+
+        shared_ptr<const ProblemInstance> instance = ProblemInstance::load(path.c_str());
+        for (int s = 0; s < seeds.size(); ++s) {
+            Random::seed(seeds[s]);
+            CVRP cvrp(instance, 120, 1000000, 0.75, 0.15, 5000);
+            cvrp.setIslands(islands, 100, 2);
+            if (localSearch >= 0) cvrp.setLocalSearch(LocalSearch(localSearch));
+            cvrp.setSelection(selection);
+            StoppingCriteria stopping;
+            stopping.timeBudget = timeBudget;
+            cvrp.setStoppingCriteria(stopping);
+
+            steady_clock::time_point start = steady_clock::now();
+            cvrp.run();
+            double elapsed = elapsedSince(start);
+            double cost = cvrp.best().cost();
+
+            printf("%s\n    {\"instance\": \"%s\", \"seed\": %llu, \"best_cost\": %.3f, ", first ? "" : ",", path.c_str(), seeds[s], cost);
+            // a reference cost, not a known optimum, the gap can be negative
+            if (reference > 0) printf("\"reference\": %.3f, \"gap_to_reference_percent\": %.4f, ", reference, 100 * (cost - reference) / reference);
+            else printf("\"reference\": null, \"gap_to_reference_percent\": null, ");
+            shared_ptr<const FitnessCache> cache = cvrp.cache();
+            printf("\"generations\": %d, \"elapsed\": %.3f, \"generations_per_second\": %.1f, ", cvrp.generationsRun(), elapsed, cvrp.generationsRun() / elapsed);
+            printf("\"cache_hit_rate\": %.4f}", cache->lookups() ? cache->hits() / (double)cache->lookups() : 0.0);
+            first = false;
+            fflush(stdout);
+        }
+    }
+    printf("\n  ]\n}\n");
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s micro instance.vrp [--min-time S]\n       %s macro instances.txt [--seeds 1,2,3] [--time S] [--islands N] [--local-search N] [--selection S] [--tournament K]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    double minTime = 0.2, timeBudget = 5;
+    int islands = 1, localSearch = 0, tournament = 2;
+    Selection::Type selection = Selection::ROULETTE;
+    vector<unsigned long long> seeds;
+    for (int a = 3; a + 1 < argc; a += 2) {
+        if (strcmp(argv[a], "--min-time") == 0) minTime = atof(argv[a + 1]);
+        else if (strcmp(argv[a], "--time") == 0) timeBudget = atof(argv[a + 1]);
+        else if (strcmp(argv[a], "--islands") == 0) islands = atoi(argv[a + 1]);
+        else if (strcmp(argv[a], "--local-search") == 0) localSearch = atoi(argv[a + 1]);
+        else if (strcmp(argv[a], "--tournament") == 0) tournament = atoi(argv[a + 1]);
+        else if (strcmp(argv[a], "--selection") == 0 && !Selection::parse(argv[a + 1], selection)) {
+            fprintf(stderr, "unknown selection %s\n", argv[a + 1]);
+            return 1;
+        }
+        else if (strcmp(argv[a], "--seeds") == 0) {
+            istringstream list(argv[a + 1]);
+            string seed;
+            while (getline(list, seed, ',')) seeds.push_back(strtoull(seed.c_str(), NULL, 10));
+        }
+    }
+    if (seeds.empty()) seeds.push_back(1);
+
+    if (strcmp(argv[1], "micro") == 0) return runMicro(argv[2], minTime);
+    if (strcmp(argv[1], "macro") == 0) return runMacro(argv[2], seeds, timeBudget, islands, localSearch, Selection(selection, tournament));
+
+    fprintf(stderr, "unknown mode %s\n", argv[1]);
+    return 1;
+}
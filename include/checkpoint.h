@@ -0,0 +1,92 @@
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include "node.h"
+#include "problem_instance.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// solver state needed to continue a run
+struct Snapshot {
+    // one population, the whole one or an island
+    struct Part {
+        int32_t generation, solutionCounter;
+        double lastSolution, temperature;
+        // generator state of every thread evolving the part, 4 words each
+        vector<uint64_t> rng;
+        // chopped genes as node indices, flattened with their sizes
+        vector<uint32_t> sizes, nodes;
+
+        Part(): generation(0), solutionCounter(0), lastSolution(0), temperature(0) {}
+    };
+
+    uint32_t dimension, capacity;
+    uint64_t seed;
+    // seconds solved before the snapshot, over all restarts
+    double elapsed;
+    double incumbentCost;
+    vector<uint32_t> incumbent;
+    vector<Part> parts;
+
+    Snapshot(): dimension(0), capacity(0), seed(0), elapsed(0), incumbentCost(0) {}
+};
+
+// periodic checkpoints written by a background thread, the solver threads
+// only hand over their parts and never wait for the disk
+//
+// the file is replaced atomically (write, fsync, rename) and holds the
+// magic "CVRPCKP1", then dimension, capacity (uint32), seed (uint64),
+// elapsed and incumbent cost (double), the incumbent as a uint32 count and
+// node indices, and a uint32 count of parts (1 to 4096), each with generation and
+// solution counter (int32), last solution and temperature (double), the
+// generator states as a uint32 count of uint64 words, and the genes as a
+// uint32 count, their uint32 sizes and their uint32 node indices
+class Checkpoint {
+  private:
+    string path_;
+    int interval_;
+
+    mutex lock_;
+    condition_variable wake_;
+    // latest part of every population, written once all parts arrived
+    Snapshot pending_;
+    vector<bool> arrived_;
+    bool dirty_, running_;
+    thread writer_;
+
+    void write();
+
+  public:
+    // a snapshot every interval generations
+    Checkpoint(const string &path, int interval);
+    // writes the last snapshot and joins the writer
+    ~Checkpoint();
+
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint &operator=(const Checkpoint&) = delete;
+
+    inline int interval() const { return interval_; }
+
+    // hand over part index of count, the header fields of the snapshot are
+    // taken from header and its parts are ignored
+    void save(const Snapshot &header, int index, int count, Snapshot::Part &&part);
+
+    // write a snapshot to a file in the format above, false on failure
+    static bool store(const string &path, const Snapshot&);
+    // read a checkpoint of the instance, exits on a bad file
+    static void load(const string &path, const ProblemInstance&, Snapshot&);
+};
+
+// customers of a solution file in the best-solution.txt route format as
+// one giant tour, customers unknown to the instance are dropped and missing
+// ones inserted at their cheapest position, exits on a bad file
+void readSolution(const char *path, const ProblemInstance&, vector<Node> &tour);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef _CONSTRUCTION_H_
+#define _CONSTRUCTION_H_
+
+#include "node.h"
+#include "problem_instance.h"
+
+#include <vector>
+
+using namespace std;
+
+// constructive heuristics for the initial population
+// each writes a giant tour (customers without depots) for Gene::chop() to
+// split, randomized by the calling thread's generator so that repeated
+// calls give a diverse population, working memory is per thread and reused
+class Construction {
+  public:
+    enum Type { SAVINGS, SWEEP, NEAREST };
+
+    // parallel Clarke-Wright savings d(0, i) + d(0, j) - shape * d(i, j)
+    // over the neighbour lists, largest first, routes in angular order
+    static void savings(const ProblemInstance&, double shape, vector<Node> &tour);
+    // customers by angle from a random start and direction, every angle
+    // jittered by up to jitter degrees
+    static void sweep(const ProblemInstance&, double jitter, vector<Node> &tour);
+    // nearest unvisited neighbour, or one of the two nearest with probability
+    // noise, continuing the sweep once the candidate list is used up
+    static void nearest(const ProblemInstance&, double noise, vector<Node> &tour);
+
+    // one of the above with random parameters
+    static void build(Type, const ProblemInstance&, vector<Node> &tour);
+    static const char *name(Type);
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef _CROSSOVER_H_
+#define _CROSSOVER_H_
+
+#include "gene.h"
+
+#include <string>
+
+using namespace std;
+
+// recombination operators behind one interface
+// RBX exchanges a whole route, OX and ERX recombine the giant tours
+// (customers without depots) and chop the child again
+// working memory is per thread and reused, so a warm operator does not allocate
+class Crossover {
+  public:
+    enum Type { RBX, OX, ERX };
+
+  private:
+    Type type_;
+
+    void rbx(const Gene&, const Gene&, Gene&) const;
+    void ox(const Gene&, const Gene&, Gene&) const;
+    void erx(const Gene&, const Gene&, Gene&) const;
+
+  public:
+    Crossover(Type type = RBX): type_(type) {}
+
+    inline Type type() const { return type_; }
+
+    // write a child of a and b into child, reusing its storage
+    // RBX keeps the better of its two children
+    void operator()(const Gene &a, const Gene &b, Gene &child) const;
+
+    // operator names for the command line: rbx, ox, erx
+    static bool parse(const string&, Type&);
+    static const char *name(Type);
+};
+
+#endif
@@ -1,31 +1,106 @@
 #ifndef _CVRP_H_
 #define _CVRP_H_
 
+#include "checkpoint.h"
+#include "crossover.h"
+#include "fitness_cache.h"
 #include "gene.h"
+#include "local_search.h"
 #include "node.h"
+#include "population.h"
+#include "problem_instance.h"
+#include "selection.h"
+#include "spsc_queue.h"
+#include "stopping.h"
+#include "telemetry.h"
 
+#include <memory>
 #include <vector>
 
 class CVRP {
-  private:
-    static int dimension_; 
-    
+    friend class Portfolio;
+
   protected:
+    shared_ptr<const ProblemInstance> instance_;
     int numOfGenes_, numOfGenerations_, solutionCounter_;
+    // generations completed by the last evolve(), the longest island in island mode
+    int generationsRun_;
     double lastSolution_, crossoverRate_, mutationRate_, temperature_;
     vector<Gene> genes_;
     
+    Crossover crossover_;
+    Selection selection_;
+    // descent applied to the chosen child of every pair, memetic_ switches it on
+    LocalSearch localSearch_;
+    bool memetic_;
+    // known local optima, shared with the islands
+    shared_ptr<FitnessCache> cache_;
+    // sorted hashes of the population before crossover,
+    // a child equal to any of them is rejected
+    vector<uint64_t> hashes_;
+    // two children per selected pair, reused every generation
+    vector<Gene> offspring_;
+    // node lists of genes_ and offspring_ in one arena, parents in the first half
+    // a chosen child trades its slot with the parent it replaces
+    Population population_;
+    
+    // island model: number of islands (1 runs a single population),
+    // generations between migrations and elites sent per migration
+    int islands_, migrationInterval_, migrants_;
+    // islands run inside one thread each and must not fork
+    bool parallel_;
+    // evolution data sink, none for quiet runs
+    shared_ptr<Telemetry> telemetry_;
+    // elites arriving from the previous island, leaving to the next one
+    SpscQueue<Gene> *inbox_, *outbox_;
+    
+    StoppingCriteria stopping_;
+    // best solution so far, shared with the islands
+    shared_ptr<Incumbent> incumbent_;
+    
+    // periodic snapshots, shared with the islands, this population is
+    // part part_ of parts_ in them
+    shared_ptr<Checkpoint> checkpoint_;
+    int part_, parts_;
+    // state to continue from instead of generating genes
+    shared_ptr<const Snapshot> resume_;
+    // generation to continue from and seconds solved before this process
+    int firstGeneration_;
+    double elapsedBefore_;
+    // giant tour of a prior solution seeding the population
+    vector<Node> warmStart_;
+    
+    // fraction of the run done, by generations or by the time budget
+    double progress(int) const;
+    // check the stopping criteria after a generation
+    // stagnant: generations since the incumbent last improved
+    bool finished(int generation, int stagnant) const;
+    
+    // one generation: adapt rates, crossover, mutate and sort
+    // returns the temperature used
+    double step(int);
+    // move genes_ and offspring_ into a fresh arena
+    void bindPopulation();
+    // exchange elites with the neighbouring islands
+    void migrate(int);
+    // continue from resume_ instead of generating genes
+    void restore();
+    // hand the state after a generation to the checkpoint writer
+    void checkpoint(int generation, double temperature);
+    // one crossover, counted and timed by the profiler
+    void breed(const Gene&, const Gene&, Gene&) const;
+    // evolve one island per thread, joined only at the end
+    void evolveIslands();
+    
   public:
-    CVRP(int numOfGenes, int numOfGenerations, double crossoverRate, double mutationRate, double temperature): numOfGenes_(numOfGenes), numOfGenerations_(numOfGenerations), crossoverRate_(crossoverRate), mutationRate_(mutationRate), temperature_(temperature), solutionCounter_(0), lastSolution_(0) {};
+    CVRP(shared_ptr<const ProblemInstance> instance, int numOfGenes, int numOfGenerations, double crossoverRate, double mutationRate, double temperature): instance_(instance), numOfGenes_(numOfGenes), numOfGenerations_(numOfGenerations), crossoverRate_(crossoverRate), mutationRate_(mutationRate), temperature_(temperature), solutionCounter_(0), generationsRun_(0), lastSolution_(0), memetic_(false), islands_(1), migrationInterval_(100), migrants_(2), parallel_(true), inbox_(nullptr), outbox_(nullptr), incumbent_(make_shared<Incumbent>()), part_(0), parts_(1), firstGeneration_(0), elapsedBefore_(0) {};
 
-    // generate genes via scanning counter-clockwise
-    // routes without depots
+    // build the initial chopped genes with the constructive heuristics in parallel
     void generateGenes();
 
-    // export evolution data for visualization
-    void exportEvolutionData(int generation, double temperature);
-    
-    // select and crossover
+    // select and crossover, the child of a pair replaces the worse parent
+    // unless it duplicates a gene of the population or an earlier child
+    // children are bred in parallel and replace their parents in pair order
     void crossover(const double&);
    
     // evolution for chopped genes
@@ -35,14 +110,50 @@ class CVRP {
     // in ascending order
     void sortByCost();
     
+    // generate and evolve, starts the clock of the time budget
+    void run();
+    
     // automation
     void solve();
     
-    // select genes by cost
-    // return genes indices
+    // draw the parent pairs of a generation from the sorted genes
+    // return gene indices, entries 2i and 2i + 1 form pair i
     vector<int> selectByCost();
     
-    static void setDimension(const int&);
+    // split the population into islands evolving without synchronisation
+    // islands <= 1 keeps the single shared population
+    void setIslands(int islands, int migrationInterval, int migrants);
+    
+    // record evolution data for visualization, released when solve() ends
+    void setTelemetry(shared_ptr<Telemetry> telemetry) { telemetry_ = telemetry; }
+    
+    void setCrossover(Crossover::Type type) { crossover_ = Crossover(type); }
+    void setSelection(const Selection &selection) { selection_ = selection; }
+    // improve offspring before they enter the population
+    void setLocalSearch(const LocalSearch &localSearch) { localSearch_ = localSearch; memetic_ = true; }
+    
+    void setStoppingCriteria(const StoppingCriteria &stopping) { stopping_ = stopping; }
+    // snapshot the run every checkpoint interval and when it ends
+    void setCheckpoint(shared_ptr<Checkpoint> checkpoint) { checkpoint_ = checkpoint; }
+    // continue a checkpointed run, the time budget starts again
+    void resume(shared_ptr<const Snapshot> snapshot) { resume_ = snapshot; }
+    // seed the initial population with a prior solution as a giant tour, see readSolution
+    void setWarmStart(const vector<Node> &tour) { warmStart_ = tour; }
+    // anytime access: called with every new incumbent while solving
+    void setIncumbentCallback(Incumbent::Callback callback) { incumbent_->setCallback(callback); }
+    // best solution so far, may be queried or stopped from another thread
+    shared_ptr<Incumbent> incumbent() const { return incumbent_; }
+    
+    // best gene after solve()
+    const Gene &best() const { return genes_[0]; }
+    int generationsRun() const { return generationsRun_; }
+    // null before run()
+    shared_ptr<const FitnessCache> cache() const { return cache_; }
+    
+    // solve many instances concurrently, one solver per instance on the
+    // shared OpenMP thread pool, each with serial inner loops and no telemetry
+    // returns the best gene of every instance
+    static vector<Gene> solveBatch(const vector< shared_ptr<const ProblemInstance> >&, int numOfGenes, int numOfGenerations, double crossoverRate, double mutationRate, double temperature);
 };
 
 #endif 
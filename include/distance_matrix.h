@@ -0,0 +1,100 @@
+#ifndef _DISTANCE_MATRIX_H_
+#define _DISTANCE_MATRIX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// compact customer index, 0-based (node tag - 1)
+#ifdef CVRP_WIDE_INDEX
+typedef uint32_t customer_t;
+#else
+typedef uint16_t customer_t;
+#endif
+
+// storage precision of the distance entries
+// costs are always accumulated in double
+#ifdef CVRP_FLOAT_DISTANCE
+typedef float distance_t;
+#else
+typedef double distance_t;
+#endif
+
+// symmetric distance lookup over one aligned contiguous buffer, or over the
+// coordinates alone when the table would not fit
+class DistanceMatrix {
+  public:
+    // ON_DEMAND keeps the coordinates and computes every lookup
+    enum Layout { AUTO, SQUARE, TRIANGULAR, ON_DEMAND };
+    // TSPLIB edge weight functions, EXACT keeps the unrounded euclidean distance
+    enum Metric { EXACT, EUC_2D, CEIL_2D, ATT, MAN_2D, MAX_2D };
+
+    // alignment of the buffer and of every square row, in bytes
+    static const size_t ALIGNMENT = 64;
+    // AUTO picks the square layout up to this dimension
+    static const size_t SQUARE_LIMIT = 2048;
+    // instances switch to ON_DEMAND above this dimension by default,
+    // the triangular table of doubles takes 400 MB here
+    static const size_t TABLE_LIMIT = 10000;
+
+  private:
+    struct AlignedFree { void operator()(void *p) const { free(p); } };
+
+    unique_ptr<distance_t[], AlignedFree> data_;
+    // offset of the first entry of each row
+    vector<size_t> row_;
+    size_t dimension_, stride_;
+    Layout layout_;
+    // coordinates and edge weight function of the ON_DEMAND layout
+    vector<double> x_, y_;
+    Metric metric_;
+
+    void allocate(size_t, Layout);
+    // copy the lower triangle into the upper one of the square layout
+    void mirror();
+
+  public:
+    DistanceMatrix(): dimension_(0), stride_(0), layout_(SQUARE), metric_(EXACT) {}
+    DistanceMatrix(DistanceMatrix&&) = default;
+    DistanceMatrix &operator=(DistanceMatrix&&) = default;
+
+    // fill from planar coordinates with the given edge weight function
+    void build(const vector<double> &x, const vector<double> &y, Metric = EXACT, Layout = AUTO);
+    // fill from an explicit lower triangle, row by row including the diagonal
+    void build(size_t dimension, const vector<double> &lower, Layout = AUTO);
+
+    // edge weight between two points under a metric
+    static double weight(Metric, double dx, double dy);
+    // ON_DEMAND lookup, kept out of line so the table lookups stay small
+    distance_t compute(size_t i, size_t j) const;
+
+    // both table layouts read the lower triangle
+    inline distance_t operator()(size_t i, size_t j) const {
+        if (layout_ == ON_DEMAND) return compute(i, j);
+        size_t lo = i < j ? i : j;
+        size_t hi = i ^ j ^ lo;
+        return data_[row_[hi] + lo];
+    }
+
+    // raw entries, row i starts at i * stride() (square) or i * (i + 1) / 2 (triangular)
+    // null for ON_DEMAND
+    inline const distance_t *data() const { return data_.get(); }
+    // coordinates of the ON_DEMAND layout
+    inline const double *x() const { return x_.data(); }
+    inline const double *y() const { return y_.data(); }
+    Metric metric() const { return metric_; }
+    // full row, only for the square layout
+    inline const distance_t *row(size_t i) const { return data_.get() + row_[i]; }
+
+    size_t dimension() const { return dimension_; }
+    size_t stride() const { return stride_; }
+    Layout layout() const { return layout_; }
+    // size of the table, or of the coordinates for ON_DEMAND
+    size_t bytes() const;
+};
+
+#endif
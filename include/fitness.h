@@ -0,0 +1,33 @@
+#ifndef _FITNESS_H_
+#define _FITNESS_H_
+
+#include "distance_matrix.h"
+#include "node.h"
+
+#include <vector>
+
+using namespace std;
+
+// path length kernels over the flat distance matrix, or over the
+// coordinates of an ON_DEMAND matrix
+// the widest kernel the CPU supports is picked once per process, all of
+// them sum the arcs into 8 interleaved double lanes reduced in a fixed
+// order, so costs are bit-identical whichever kernel runs
+class Fitness {
+  public:
+    enum Kernel { SCALAR, AVX2, AVX512 };
+
+    // kernel in use, CVRP_SIMD=scalar|avx2|avx512 caps it
+    static Kernel kernel();
+    static bool supported(Kernel);
+    static const char *name(Kernel);
+
+    // sum of the arcs between consecutive nodes
+    static double cost(const DistanceMatrix&, const Node*, int);
+    // with a given kernel, unsupported ones fall back to the scalar kernel
+    static double cost(Kernel, const DistanceMatrix&, const Node*, int);
+    // score many paths at once
+    static void costs(const DistanceMatrix&, const Node *const *paths, const int *sizes, int count, double *costs);
+};
+
+#endif
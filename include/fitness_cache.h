@@ -0,0 +1,44 @@
+#ifndef _FITNESS_CACHE_H_
+#define _FITNESS_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+using namespace std;
+
+// lock-free direct-mapped table from solution hashes (see Zobrist) to costs
+// and flags, shared by every thread working on one instance
+// an entry is written as three words checked by their xor, so a reader
+// either sees a whole entry or a miss, and a newer entry simply replaces an
+// older one in its slot
+class FitnessCache {
+  public:
+    enum Flag { LOCAL_OPTIMUM = 1 };
+
+  private:
+    struct Entry {
+        atomic<uint64_t> check, cost, flags;
+    };
+
+    unique_ptr<Entry[]> entries_;
+    uint64_t mask_;
+    mutable atomic<long> lookups_, hits_;
+
+  public:
+    // 2^bits entries of 24 bytes
+    explicit FitnessCache(int bits = 16);
+
+    FitnessCache(const FitnessCache&) = delete;
+    FitnessCache &operator=(const FitnessCache&) = delete;
+
+    // flags of the entry of a solution, 0 if it is not cached
+    // the cost guards against hash collisions
+    unsigned find(uint64_t hash, double cost) const;
+    void insert(uint64_t hash, double cost, unsigned flags);
+
+    long lookups() const { return lookups_.load(memory_order_relaxed); }
+    long hits() const { return hits_.load(memory_order_relaxed); }
+};
+
+#endif
@@ -2,51 +2,133 @@
 #define _GENE_H_
 
 #include "node.h"
+#include "node_list.h"
+#include "problem_instance.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <vector>
 
 class Gene {
-  private:
-    static int capacity_, dimension_;
-    
+    // operators write children directly into the node list
+    friend class Crossover;
+    friend class LocalSearch;
+
   protected:
-    vector<Node> nodes_;
+    // the instance is owned by the solver and outlives its genes
+    const ProblemInstance *instance_;
+    NodeList nodes_;
     
+    // cached fitness and route count, kept current by every mutating operation
+    double cost_;
+    int routes_;
+    // Zobrist hash of the route set, kept current like the cost
+    // scored_ is the hash at the last full cost evaluation
+    uint64_t hash_, scored_;
+    
+    // route index of a chopped gene, a depot opens the route after it
+    // routeOf_/prefixLoad_ per position, load_/routeCost_ per route
+    // routeStart_ holds the opening depot of every route plus the final depot,
+    // so route r spans [routeStart_[r], routeStart_[r + 1])
+    // position_ maps a customer index to its position in nodes_
+    // rebuilt lazily, indexed_ is cleared whenever the nodes are replaced
+    vector<int> routeOf_, prefixLoad_, load_, routeStart_, position_;
+    vector<double> routeCost_;
+    vector<uint64_t> routeHash_;
+    // routes over capacity and routes emptied by moves since the last compaction
+    int overloaded_, emptied_;
+    bool indexed_;
+
+    // recompute the cached cost and route count, drop the route index
+    void update();
+    void indexRoutes();
+    void indexRoute(int);
+    // reindex positions [lo, hi] after a node moved within them
+    void indexSpan(int, int);
+    // drop empty routes in one pass
+    void compact();
+    // debug builds check the index against a full rebuild
+    void checkIndex() const;
+    
+    // distance between the nodes at two positions
+    inline double distance(int p, int q) const { return instance_->distance(nodes_[p].index(), nodes_[q].index()); }
+    inline int demand(const Node &node) const { return instance_->demand(node.index()); }
+    
+    // cost change of rearranging positions, see gene.cc
+    template <typename Source>
+    double arcDelta(const int*, int, Source) const;
     
   public:
+    // candidate move on a chopped gene, evaluated before it is applied
+    // INSERTION: move the node at from in front of position to
+    // SWAP: swap from and to
+    // EXCHANGE: swap from and to, then from + 1 and to - 1
+    // SEGMENT_SWAP: swap from - j and to + j for j < length
+    struct Move {
+        enum Type { INSERTION, SWAP, EXCHANGE, SEGMENT_SWAP };
+        Type type;
+        int from, to, length;
+        
+        Move(Type type, int from, int to, int length = 0): type(type), from(from), to(to), length(length) {}
+    };
+
+
     // constructors
-    Gene() {}
-    Gene(const vector<Node> &nodes): nodes_(nodes) {}
-    Gene(const Gene &gene): nodes_(gene.nodes_) {}
-    Gene(const Gene *gp): nodes_(gp->nodes_) {}
+    Gene(): instance_(nullptr), cost_(0), routes_(0), hash_(0), scored_(0), overloaded_(0), emptied_(0), indexed_(false) {}
+    Gene(const ProblemInstance *instance, const vector<Node> &nodes): instance_(instance), nodes_(nodes), overloaded_(0), emptied_(0), indexed_(false) { update(); }
+    Gene(const Gene &gene): instance_(gene.instance_), nodes_(gene.nodes_), cost_(gene.cost_), routes_(gene.routes_), hash_(gene.hash_), scored_(gene.scored_), overloaded_(0), emptied_(0), indexed_(false) {}
+    Gene(const Gene *gp): instance_(gp->instance_), nodes_(gp->nodes_), cost_(gp->cost_), routes_(gp->routes_), hash_(gp->hash_), scored_(gp->scored_), overloaded_(0), emptied_(0), indexed_(false) {}
+    Gene(Gene&&) = default;
+    
+    // move the node list into an arena slot, see Population
+    inline void place(Node *slot, int capacity) { nodes_.place(slot, capacity); }
     
     Gene &operator=(const Gene&);
+    Gene &operator=(Gene&&) = default;
     
-    double cost() const;
+    inline double cost() const { return cost_; }
+    inline const NodeList &nodes() const { return nodes_; }
+    // equal for genes with the same routes in any order and direction
+    inline uint64_t hash() const { return hash_; }
+    // recompute the costs of many genes in one batch, the route index is kept
+    // genes whose arcs did not change since they were last scored are skipped
+    static void evaluate(Gene*, int);
+    // number of routes of a chopped gene
+    inline int routes() const { return routes_; }
     // if not chopped, chop it first
-    void print() const;
-
-    // crossover for chopped genes
-    Gene Rbx(const Gene&, const double&);
+    void print(FILE* = stdout) const;
 
-    // insert depots to the customer node list
+    // split the customer node list into routes and insert the depots
     void chop();
    
-    vector<int> randomPos();
+    void randomPos(int&, int&) const;
     // triple mutation for unchopped genes
     void sequentialMutate(const double&, const double&);
     // random pick 2 nodes to exchange
     void optMutation(const double&);
     
-    // replace current gene based on some criterion
-    void acceptGene(Gene&, const double&);
-    // check if vehicles overloaded and remove neighboring depots
+    // O(1) cost change and capacity check of a move, needs the route index
+    double delta(const Move&) const;
+    bool feasible(const Move&) const;
+    // apply a move in place and keep the route index up to date
+    void apply(const Move&);
+    
+    // Metropolis criterion on the cost change of a candidate move
+    bool accept(const double&, const double&) const;
+    // true if no vehicle is overloaded, O(1) once the gene is indexed
     bool validate();
-
-    static int setDimensionAndCapacity(const vector<int>&);   
+    
+    inline void ensureIndexed() { if (!indexed_) indexRoutes(); }
+    // route index queries, valid after ensureIndexed() until the nodes change
+    inline int routeBegin(int r) const { return routeStart_[r]; }
+    inline int routeEnd(int r) const { return routeStart_[r + 1]; }
+    inline int routeLoad(int r) const { return load_[r]; }
+    inline double routeCost(int r) const { return routeCost_[r]; }
+    // load of the route up to and from a position, both inclusive
+    inline int prefixLoad(int p) const { return prefixLoad_[p]; }
+    inline int suffixLoad(int p) const { return load_[routeOf_[p]] - prefixLoad_[p] + demand(nodes_[p]); }
 };
 
-double vectorCost(const vector<Node>&);
+double vectorCost(const ProblemInstance&, const vector<Node>&);
 
 #endif 
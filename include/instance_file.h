@@ -0,0 +1,32 @@
+#ifndef _INSTANCE_FILE_H_
+#define _INSTANCE_FILE_H_
+
+#include "distance_matrix.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// contents of a CVRPLIB/TSPLIB instance file, node indices start from 0
+struct InstanceFile {
+    string name;
+    int dimension, capacity;
+    // edge weights come from the coordinates unless explicit is set
+    DistanceMatrix::Metric metric;
+    bool explicitWeights;
+    // node coordinates, or display coordinates of an explicit instance
+    bool hasCoordinates;
+    vector<double> x, y;
+    vector<int> demands;
+    // explicit weights as a lower triangle, row by row including the diagonal
+    vector<double> lower;
+
+    InstanceFile(): dimension(0), capacity(0), metric(DistanceMatrix::EXACT), explicitWeights(false), hasCoordinates(false) {}
+};
+
+// memory-map the file and parse it in one pass
+// exits with a message on malformed or unsupported input
+void readInstance(const char*, InstanceFile&);
+
+#endif
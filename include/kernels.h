@@ -0,0 +1,88 @@
+#ifndef _KERNELS_H_
+#define _KERNELS_H_
+
+#include "distance_matrix.h"
+#include "problem_instance.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// compile-time shapes of the split and local search kernels
+// a shape fixes the width of the node ids in the working arrays, the
+// arithmetic of costs and deltas and, for small instances, a bound on the
+// dimension that gives every working array a fixed size
+// all shapes give the same results: integer costs are only used when every
+// distance is an integer, where double sums are exact as well
+class Kernels {
+  public:
+    // WIDE: 32-bit ids, distances from the instance
+    // NARROW: 16-bit ids, distances from the instance
+    // SMALL: 16-bit ids, fixed arrays, double costs read straight from the square table
+    // SMALL_INTEGER: as SMALL over the integer table of the instance
+    enum Shape { WIDE, NARROW, SMALL, SMALL_INTEGER };
+
+    // dimension bound of the SMALL shapes, and of the integer table
+    static const int SMALL_DIMENSION = 1024;
+    // largest dimension whose node ids, depots of the local search
+    // included, fit 16 bits
+    static const int NARROW_DIMENSION = 21844;
+
+    // best shape for an instance, CVRP_KERNEL=wide|narrow|small caps it
+    static Shape shape(const ProblemInstance&);
+    static const char *name(Shape);
+};
+
+// working array of a kernel, fixed at compile time when N is given,
+// a growing vector otherwise
+template <typename T, size_t N>
+struct Buffer {
+    T data[N];
+
+    inline void resize(size_t) {}
+    inline void assign(size_t n, const T &value) { fill(data, data + n, value); }
+    inline T &operator[](size_t i) { return data[i]; }
+    inline const T &operator[](size_t i) const { return data[i]; }
+};
+
+template <typename T>
+struct Buffer<T, 0>: vector<T> {};
+
+// distance reads of the shapes, the depot is node 0
+
+// any layout, through the instance
+struct InstanceLookup {
+    typedef double Cost;
+    const ProblemInstance *instance;
+
+    InstanceLookup(): instance(nullptr) {}
+    explicit InstanceLookup(const ProblemInstance &i): instance(&i) {}
+    inline Cost operator()(int a, int b) const { return instance->distance(a, b); }
+};
+
+// rows of the square table, no layout test and no index ordering
+struct SquareLookup {
+    typedef double Cost;
+    const distance_t *data;
+    size_t stride;
+
+    SquareLookup(): data(nullptr), stride(0) {}
+    explicit SquareLookup(const ProblemInstance &i): data(i.distances().data()), stride(i.distances().stride()) {}
+    inline Cost operator()(int a, int b) const { return data[a * stride + b]; }
+};
+
+// rows of the integer table, summed in 64 bits
+struct IntegerLookup {
+    typedef int64_t Cost;
+    const int32_t *data;
+    size_t stride;
+
+    IntegerLookup(): data(nullptr), stride(0) {}
+    explicit IntegerLookup(const ProblemInstance &i): data(i.integerDistances()), stride(i.dimension()) {}
+    inline Cost operator()(int a, int b) const { return data[a * stride + b]; }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef _LOCAL_SEARCH_H_
+#define _LOCAL_SEARCH_H_
+
+#include "fitness_cache.h"
+#include "gene.h"
+#include "kernels.h"
+
+#include <memory>
+
+using namespace std;
+
+// deterministic descent for chopped genes over the granular neighbourhoods
+// relocate and Or-opt (segments of up to 3, either orientation), swap,
+// intra-route 2-opt and inter-route 2-opt* for every customer and its
+// nearest neighbours, plus SWAP* between routes with overlapping sectors
+// moves keep every route within capacity, customers whose routes did not
+// change since their last fruitless scan are skipped (don't-look bits)
+// working memory is per thread and reused
+// the scan order is drawn from the gene's hash, so equal genes descend
+// alike and known local optima in the cache are skipped without a change
+class LocalSearch {
+  private:
+    // move evaluations allowed per call, 0 runs to a local optimum
+    int budget_;
+    // apply the best move of a customer instead of the first improving one
+    bool bestImprovement_;
+    // local optima found so far, shared between threads
+    shared_ptr<FitnessCache> cache_;
+
+    // run one shape of the search, see Kernels, true if it reached a local optimum
+    template <class Search>
+    bool descend(Gene&) const;
+
+  public:
+    LocalSearch(int budget = 0, bool bestImprovement = false): budget_(budget), bestImprovement_(bestImprovement) {}
+
+    inline int budget() const { return budget_; }
+    inline bool bestImprovement() const { return bestImprovement_; }
+    void setCache(shared_ptr<FitnessCache> cache) { cache_ = cache; }
+
+    // improve the gene in place, returns the cost change
+    double operator()(Gene&) const;
+    // with a given kernel shape, shapes the instance does not allow fall back to its own
+    double operator()(Gene&, Kernels::Shape) const;
+};
+
+#endif
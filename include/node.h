@@ -1,41 +1,31 @@
 #ifndef _NODE_H_
 #define _NODE_H_
 
+#include "distance_matrix.h"
+
 #include <cstdio>
 #include <vector>
 
 using namespace std;
 
-// nodes with demands
+// a node of the problem instance, the demands and distances
+// live in the ProblemInstance the node belongs to
+// trivially copyable, node lists are copied with memcpy
 class Node {
-  private:
-    static vector<int> demandList_;
-    static vector< vector<double> > angleTable_, distanceTable_;
   protected:
-    // the node number, starting from 1
-    int tag_;
+    // the node index, starting from 0 (tag - 1)
+    customer_t index_;
   public:
     // constructors
-    Node(const int tag): tag_(tag) {}
-    Node(const Node &node): tag_(node.tag_) {}
+    Node(const int tag): index_(tag - 1) {}
     
-    // return distance between two nodes
-    double operator()(const Node&) const;
     // compare operator
-    bool operator<(const Node&) const;
-    bool operator==(const Node&) const;
-    bool operator!=(const Node&) const;
-
-    Node &operator=(const Node &);
-    
-    double angle() const;
-    int demand() const;
-    int getCapacity() const;
-    int getDimension() const;
+    inline bool operator<(const Node &node) const { return index_ < node.index_; }
+    inline bool operator==(const Node &node) const { return index_ == node.index_; }
+    inline bool operator!=(const Node &node) const { return index_ != node.index_; }
  
     int tag() const;
-
-    static vector<int> initialize(const char*);
+    inline customer_t index() const { return index_; }
 };
 
 #endif
@@ -0,0 +1,119 @@
+#ifndef _NODE_LIST_H_
+#define _NODE_LIST_H_
+
+#include "node.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// contiguous node list of a gene
+// the storage is either owned or a slot of a Population arena that outlives
+// the list, copies are a memcpy and only reallocate when the capacity is short
+// a slot is referenced by one list at a time: moves hand it over, copies never share it
+class NodeList {
+  private:
+    Node *data_;
+    int size_, capacity_;
+    bool owned_;
+
+    // grow into owned storage, also when an arena slot is too short
+    void reserve(int capacity) {
+        if (capacity <= capacity_) return;
+        capacity = max(capacity, 2 * capacity_);
+        Node *data = static_cast<Node*>(malloc(capacity * sizeof(Node)));
+        if (!data) throw bad_alloc();
+        if (size_) memcpy(data, data_, size_ * sizeof(Node));
+        if (owned_) free(data_);
+        data_ = data;
+        capacity_ = capacity;
+        owned_ = true;
+    }
+
+  public:
+    typedef Node *iterator;
+    typedef const Node *const_iterator;
+
+    NodeList(): data_(nullptr), size_(0), capacity_(0), owned_(false) {}
+    NodeList(const vector<Node> &nodes): NodeList() { assign(nodes.begin(), nodes.end()); }
+    NodeList(const NodeList &list): NodeList() { *this = list; }
+    NodeList(NodeList &&list) noexcept: NodeList() { swap(list); }
+    ~NodeList() { if (owned_) free(data_); }
+
+    NodeList &operator=(const NodeList &list) {
+        if (this != &list) assign(list.begin(), list.end());
+        return *this;
+    }
+    NodeList &operator=(NodeList &&list) noexcept {
+        swap(list);
+        return *this;
+    }
+
+    void swap(NodeList &list) noexcept {
+        std::swap(data_, list.data_);
+        std::swap(size_, list.size_);
+        std::swap(capacity_, list.capacity_);
+        std::swap(owned_, list.owned_);
+    }
+
+    // move the content into an arena slot of the given capacity
+    void place(Node *slot, int capacity) {
+        if (size_ > capacity) return;
+        if (size_) memcpy(slot, data_, size_ * sizeof(Node));
+        if (owned_) free(data_);
+        data_ = slot;
+        capacity_ = capacity;
+        owned_ = false;
+    }
+
+    inline int size() const { return size_; }
+    inline bool empty() const { return size_ == 0; }
+    inline Node &operator[](int i) { return data_[i]; }
+    inline const Node &operator[](int i) const { return data_[i]; }
+    inline Node *data() { return data_; }
+    inline const Node *data() const { return data_; }
+    inline iterator begin() { return data_; }
+    inline iterator end() { return data_ + size_; }
+    inline const_iterator begin() const { return data_; }
+    inline const_iterator end() const { return data_ + size_; }
+    inline Node &back() { return data_[size_ - 1]; }
+    inline const Node &back() const { return data_[size_ - 1]; }
+
+    inline void clear() { size_ = 0; }
+    inline void push_back(const Node &node) {
+        if (size_ == capacity_) reserve(size_ + 1);
+        data_[size_++] = node;
+    }
+    void resize(int size, const Node &value) {
+        reserve(size);
+        for (int i = size_; i < size; ++i) data_[i] = value;
+        size_ = size;
+    }
+    void assign(int size, const Node &value) {
+        size_ = 0;
+        resize(size, value);
+    }
+    template <typename Iterator>
+    void assign(Iterator first, Iterator last) {
+        int size = last - first;
+        size_ = 0;
+        reserve(size);
+        copy(first, last, data_);
+        size_ = size;
+    }
+    // remove [first, last), returns the position after the removed range
+    iterator erase(iterator first, iterator last) {
+        memmove(first, last, (end() - last) * sizeof(Node));
+        size_ -= last - first;
+        return first;
+    }
+    inline iterator erase(iterator position) { return erase(position, position + 1); }
+};
+
+inline void swap(NodeList &a, NodeList &b) noexcept { a.swap(b); }
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _POPULATION_H_
+#define _POPULATION_H_
+
+#include "node.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+
+using namespace std;
+
+// one contiguous arena for the node lists of a population
+// slots have a fixed stride large enough for any chopped gene, rounded to cache lines
+class Population {
+  public:
+    static const size_t ALIGNMENT = 64;
+
+  private:
+    struct AlignedFree { void operator()(void *p) const { free(p); } };
+
+    unique_ptr<Node[], AlignedFree> arena_;
+    int slots_, stride_;
+
+  public:
+    Population(): slots_(0), stride_(0) {}
+    Population(Population&&) = default;
+    Population &operator=(Population&&) = default;
+    Population(const Population&) = delete;
+    Population &operator=(const Population&) = delete;
+
+    // room for the given number of genes of an instance dimension
+    // drops the previous arena, its slots must no longer be referenced
+    void allocate(int slots, int dimension);
+
+    inline Node *slot(int i) const { return arena_.get() + (size_t)i * stride_; }
+    inline int slots() const { return slots_; }
+    inline int stride() const { return stride_; }
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef _PORTFOLIO_H_
+#define _PORTFOLIO_H_
+
+#include "cvrp.h"
+#include "gene.h"
+#include "stopping.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// multi-start runner: many independent serial solves of one instance with
+// their own seeds and parameter sets on the threads of the shared OpenMP
+// pool, queued runs start as threads free up
+// a monitor thread samples the progress curve of every run, best cost
+// against seconds since the run started, and stops a run through its
+// incumbent once it is clearly dominated: past the warm-up it costs more
+// than (1 + margin) times the best any other run had reached after the
+// same time, its thread then takes a queued run or a freshly drawn one
+// the time budget of the prototype holds for the whole portfolio, a run
+// gets what is left of it when it starts
+// the result depends on thread timing, a seed does not reproduce it
+class Portfolio {
+  public:
+    // parameters of one run and what became of it
+    struct Run {
+        uint64_t seed;
+        int numOfGenes;
+        double crossoverRate, mutationRate, temperature;
+
+        double cost, elapsed;
+        int generations;
+        bool cancelled;
+        // (seconds, best cost) samples of the monitor, ending with the final cost
+        // a run queued past the deadline has no curve and an infinite cost
+        vector< pair<double, double> > curve;
+
+        Run(): seed(0), numOfGenes(0), crossoverRate(0), mutationRate(0), temperature(0), cost(0), elapsed(0), generations(0), cancelled(false) {}
+    };
+
+  private:
+    // operators, stopping criteria and warm start shared by every run
+    const CVRP &prototype_;
+    vector<Run> runs_;
+    double margin_, warmup_;
+    // best solution of all runs
+    shared_ptr<Incumbent> incumbent_;
+
+    // parameters drawn around the prototype from a seed
+    static Run draw(const CVRP &prototype, uint64_t seed);
+
+  public:
+    // warmup: seconds a run is left alone before it can be cancelled
+    Portfolio(const CVRP &prototype, const vector<Run> &runs, double margin = 0.02, double warmup = 1);
+
+    // n parameter sets: the prototype's own first, then seeded draws of the
+    // population size, the rates and the starting temperature around it
+    static vector<Run> sample(const CVRP &prototype, int n, uint64_t seed);
+
+    // solve every run, returns the best gene
+    Gene solve();
+
+    // parameters and statistics of every run after solve(), the given
+    // ones first, then the fresh runs that replaced cancelled ones
+    const vector<Run> &runs() const { return runs_; }
+    // best of all runs, may be queried or given a callback while solving
+    shared_ptr<Incumbent> incumbent() const { return incumbent_; }
+};
+
+#endif
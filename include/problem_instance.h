@@ -0,0 +1,51 @@
+#ifndef _PROBLEM_INSTANCE_H_
+#define _PROBLEM_INSTANCE_H_
+
+#include "distance_matrix.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// immutable problem data shared by every solver working on one instance
+// node indices start from 0, the depot is node 0
+class ProblemInstance {
+  private:
+    int dimension_, capacity_;
+    vector<int> demands_;
+    // polar angle of every node around the depot
+    vector<double> angles_;
+    DistanceMatrix distance_;
+    // square copy of the distances for small instances whose distances are
+    // all integers, as with the rounded TSPLIB metrics, empty otherwise
+    vector<int32_t> integers_;
+    // k nearest customers of every node, row-major by node index
+    vector<customer_t> neighbours_;
+    int neighbourCount_;
+
+  public:
+    // the second argument caps the candidate list length, instances with
+    // coordinates above tableLimit nodes compute their distances on demand
+    ProblemInstance(const char*, int=20, int tableLimit=DistanceMatrix::TABLE_LIMIT);
+
+    ProblemInstance(const ProblemInstance&) = delete;
+    ProblemInstance &operator=(const ProblemInstance&) = delete;
+
+    static shared_ptr<const ProblemInstance> load(const char*, int=20, int tableLimit=DistanceMatrix::TABLE_LIMIT);
+
+    inline int dimension() const { return dimension_; }
+    inline int capacity() const { return capacity_; }
+    inline int demand(customer_t i) const { return demands_[i]; }
+    inline double angle(customer_t i) const { return angles_[i]; }
+    inline double distance(customer_t i, customer_t j) const { return distance_(i, j); }
+    // nearest customers by distance, excluding the depot and itself
+    inline const customer_t *neighbours(customer_t i) const { return &neighbours_[(size_t)i * neighbourCount_]; }
+    inline int neighbourCount() const { return neighbourCount_; }
+    inline const DistanceMatrix &distances() const { return distance_; }
+    // rows of dimension() entries, null without an integer table
+    inline const int32_t *integerDistances() const { return integers_.empty()? nullptr : integers_.data(); }
+};
+
+#endif
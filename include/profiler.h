@@ -0,0 +1,124 @@
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+using namespace std;
+
+// per-operator counters and cycle timers
+// every thread counts into its own slot, written by that thread only,
+// so the hot path is a plain load, add and store without a locked instruction
+// the slots are summed when a report is written, which may happen while
+// the solver runs, on SIGUSR1, or at the end of the run
+// building without CVRP_PROFILE leaves empty inline calls that compile away
+class Profiler {
+  public:
+    enum Operator {
+        // the five moves of Gene::sequentialMutate, counted but not timed,
+        // a timer would cost more than the move
+        INSERT, INSERT_BACK, SWAP, EXCHANGE, SEGMENT_SWAP,
+        // the in-route swaps of Gene::optMutation, counted only
+        OPT_SWAP,
+        // one call of Gene::sequentialMutate or Gene::optMutation
+        MUTATE, OPT_MUTATE,
+        CROSSOVER, LOCAL_SEARCH, SELECTION, EVALUATE, SORT, MIGRATION, CONSTRUCTION,
+        // one whole generation
+        GENERATION,
+        OPERATORS
+    };
+
+    // what happened to an attempt, counted on top of attempts
+    // FEASIBLE: the move kept every route within capacity
+    // ACCEPTED: the result was kept, IMPROVED: it lowered the cost,
+    // UPHILL: it was kept although it raised the cost
+    enum Outcome { ATTEMPTS, FEASIBLE, ACCEPTED, IMPROVED, UPHILL, CYCLES, OUTCOMES };
+
+#ifdef CVRP_PROFILE
+    static const bool enabled = true;
+
+    struct Slot {
+        // a cache line on each side keeps neighbouring slots apart
+        char before[64];
+        atomic<uint64_t> counts[OPERATORS][OUTCOMES];
+        char after[64];
+    };
+
+  private:
+    // register a slot for the calling thread, slots live until the process ends
+    static Slot *attach();
+
+    static inline Slot &local() {
+        static thread_local Slot *slot = nullptr;
+        if (!slot) slot = attach();
+        return *slot;
+    }
+
+  public:
+    // cycles on x86, nanoseconds elsewhere, converted to seconds in the report
+    static inline uint64_t ticks() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        return __rdtsc();
+#else
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static inline void count(Operator op, Outcome outcome, uint64_t n = 1) {
+        atomic<uint64_t> &c = local().counts[op][outcome];
+        c.store(c.load(memory_order_relaxed) + n, memory_order_relaxed);
+    }
+
+    // a feasible attempt with its cost change, accepted if the result was kept
+    static inline void result(Operator op, double delta, bool accepted) {
+        count(op, FEASIBLE);
+        if (!accepted) return;
+        count(op, ACCEPTED);
+        if (delta < 0) count(op, IMPROVED);
+        else if (delta > 0) count(op, UPHILL);
+    }
+
+    // times its scope as one attempt of op
+    class Scope {
+        Operator op_;
+        uint64_t start_;
+      public:
+        explicit Scope(Operator op): op_(op), start_(ticks()) {}
+        ~Scope() {
+            count(op_, ATTEMPTS);
+            count(op_, CYCLES, ticks() - start_);
+        }
+    };
+#else
+    static const bool enabled = false;
+
+    static inline uint64_t ticks() { return 0; }
+    static inline void count(Operator, Outcome, uint64_t = 1) {}
+    static inline void result(Operator, double, bool) {}
+
+    class Scope {
+      public:
+        explicit Scope(Operator) {}
+    };
+#endif
+
+    // report to path, CSV if it ends in .csv, JSON otherwise,
+    // and write it whenever the process receives SIGUSR1
+    static void open(const string &path);
+    // write the report if SIGUSR1 arrived since the last call, called by the
+    // solver between generations, since the handler itself must not write
+    static void poll();
+    // write the report now, nothing without a path or CVRP_PROFILE
+    static void write();
+
+    static const char *name(Operator);
+};
+
+#endif
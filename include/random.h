@@ -0,0 +1,83 @@
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+// xoshiro256** generator, usable as a UniformRandomBitGenerator
+class Xoshiro256 {
+  private:
+    uint64_t s_[4];
+
+    static inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  public:
+    typedef uint64_t result_type;
+
+    explicit Xoshiro256(uint64_t seed = 0) { this->seed(seed); }
+
+    // expand a 64-bit seed into the full state with splitmix64
+    void seed(uint64_t);
+    // advance by 2^128 draws, used to split non-overlapping streams
+    void jump();
+    // raw state, for checkpoints
+    inline void state(uint64_t out[4]) const { for (int i = 0; i < 4; ++i) out[i] = s_[i]; }
+    inline void setState(const uint64_t in[4]) { for (int i = 0; i < 4; ++i) s_[i] = in[i]; }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    inline result_type operator()() {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // unbiased integer in [0, bound), Lemire's multiply-shift rejection
+    inline uint32_t below(uint32_t bound) {
+        uint64_t m = (uint64_t)(uint32_t)((*this)() >> 32) * bound;
+        uint32_t l = (uint32_t)m;
+        if (l < bound) {
+            uint32_t t = (0u - bound) % bound;
+            while (l < t) {
+                m = (uint64_t)(uint32_t)((*this)() >> 32) * bound;
+                l = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    // real number in [0, 1) with 53 random bits
+    inline double real() { return ((*this)() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+// per-thread generators split from one master seed
+// a run is reproducible for a given seed and thread count
+class Random {
+  private:
+    static uint64_t seed_;
+    // bumped by seed() so every thread restarts its stream
+    static atomic<unsigned> epoch_;
+
+  public:
+    static void seed(uint64_t);
+    static uint64_t seed() { return seed_; }
+
+    // the calling thread's generator, stream index = OpenMP thread number
+    static Xoshiro256 &engine();
+
+    // integer in [lower, upper)
+    static inline int uniformInt(int lower, int upper) { return lower + (int)engine().below((uint32_t)(upper - lower)); }
+    // real number in [0, 1)
+    static inline double uniformReal() { return engine().real(); }
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef _SELECTION_H_
+#define _SELECTION_H_
+
+#include "gene.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// parent selection over a population sorted by cost
+// ROULETTE draws in O(1) from a Walker alias table, the weight of a gene
+// falls linearly from the best cost to the worst, TOURNAMENT returns the
+// best of k uniform draws
+// prepare() once per generation, draws are then const and thread-safe,
+// each thread using its own generator
+class Selection {
+  public:
+    enum Type { ROULETTE, TOURNAMENT };
+
+  private:
+    Type type_;
+    int tournamentSize_;
+    int size_;
+    // alias table: slot i keeps i with probability_[i], otherwise alias_[i]
+    vector<double> probability_;
+    vector<int> alias_;
+    // slots split by prepare(), kept to avoid allocating every generation
+    vector<int> small_, large_;
+
+  public:
+    Selection(Type type = ROULETTE, int tournamentSize = 2): type_(type), tournamentSize_(tournamentSize > 1 ? tournamentSize : 2), size_(0) {}
+
+    inline Type type() const { return type_; }
+
+    // build the sampling table for n genes
+    void prepare(const Gene *genes, int n);
+    // index of one parent
+    int operator()() const;
+    // a pair of distinct parents, needs at least 2 genes
+    void pair(int &p, int &q) const;
+
+    // strategy names for the command line: roulette, tournament
+    static bool parse(const string&, Type&);
+    static const char *name(Type);
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef _SPLIT_H_
+#define _SPLIT_H_
+
+#include "node.h"
+#include "problem_instance.h"
+
+#include <vector>
+
+using namespace std;
+
+// optimal split of a giant tour (customers only) into capacity feasible
+// routes visited in tour order, linear time with Vidal's deque algorithm
+// writes the exclusive end of every route within the tour into ends
+// and returns the total cost, working memory is per thread and reused
+double split(const ProblemInstance&, const Node *tour, int n, vector<int> &ends);
+
+#endif
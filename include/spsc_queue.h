@@ -0,0 +1,48 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// lock-free single-producer single-consumer ring buffer
+// carries elite genes between islands and records to the telemetry writer
+template <typename T>
+class SpscQueue {
+  private:
+    vector<T> slots_;
+    // head_ is advanced by the consumer, tail_ by the producer
+    // padded apart so the two sides do not share a cache line
+    atomic<size_t> head_;
+    char pad_[64];
+    atomic<size_t> tail_;
+
+  public:
+    explicit SpscQueue(size_t capacity): slots_(capacity + 1), head_(0), tail_(0) {}
+
+    // producer side, drops the item when the queue is full
+    bool push(const T &item) {
+        size_t tail = tail_.load(memory_order_relaxed);
+        size_t next = (tail + 1) % slots_.size();
+        if (next == head_.load(memory_order_acquire)) return false;
+        slots_[tail] = item;
+        tail_.store(next, memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return head_.load(memory_order_acquire) == tail_.load(memory_order_acquire); }
+
+    // consumer side, swaps so the slot keeps the old buffers for reuse
+    bool pop(T &item) {
+        size_t head = head_.load(memory_order_relaxed);
+        if (head == tail_.load(memory_order_acquire)) return false;
+        swap(item, slots_[head]);
+        head_.store((head + 1) % slots_.size(), memory_order_release);
+        return true;
+    }
+};
+
+#endif
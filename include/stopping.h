@@ -0,0 +1,66 @@
+#ifndef _STOPPING_H_
+#define _STOPPING_H_
+
+#include "gene.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+using namespace std;
+
+// when evolve() stops, the first criterion met wins
+// a zero disables a criterion
+struct StoppingCriteria {
+    // wall clock seconds since solving started
+    double timeBudget;
+    // generations to run at most, 0 runs numOfGenerations
+    int generations;
+    // generations without a better incumbent
+    int stagnation;
+    // stop once the incumbent cost reaches this value
+    double targetCost;
+    
+    StoppingCriteria(): timeBudget(0), generations(0), stagnation(0), targetCost(0) {}
+};
+
+// best solution found so far, shared by every island of one solve
+// safe to read from any thread while the solver runs
+class Incumbent {
+  public:
+    // receives each new incumbent and the seconds since the start
+    typedef function<void(const Gene&, double)> Callback;
+    
+  private:
+    mutable mutex lock_;
+    Gene gene_;
+    double time_;
+    // lock-free copy of the incumbent cost for the hot path
+    atomic<double> cost_;
+    atomic<bool> stop_;
+    chrono::steady_clock::time_point start_;
+    Callback callback_;
+    
+  public:
+    Incumbent();
+    
+    // reset the clock and forget the incumbent
+    void start();
+    double elapsed() const;
+    
+    // keep the gene if it beats the incumbent, returns true on improvement
+    bool offer(const Gene&);
+    inline double cost() const { return cost_.load(memory_order_relaxed); }
+    // copy of the incumbent and the time it was found
+    Gene get(double *time = nullptr) const;
+    
+    // called under the incumbent lock, so calls arrive in improving order
+    void setCallback(Callback);
+    
+    // ask every island of the solve to stop after its current generation
+    void stop() { stop_.store(true, memory_order_relaxed); }
+    bool stopped() const { return stop_.load(memory_order_relaxed); }
+};
+
+#endif
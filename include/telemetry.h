@@ -0,0 +1,64 @@
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// one sample of the evolution process
+struct EvolutionRecord {
+    int32_t generation, solutionCounter;
+    double bestCost, temperature;
+};
+
+// evolution data sink, the solver only pushes sampled records into a ring
+// buffer and a background thread does all formatting and file output
+//
+// the CSV keeps the columns read by visualize_evolution.py
+// the optional binary file is columnar: the magic "CVRPEVO1", then blocks of
+// a uint32 count followed by the generation, best cost, temperature and
+// solution counter columns (int32, double, double, int32)
+class Telemetry {
+  public:
+    // sample every n-th generation, or only generations improving the best cost
+    enum Sampling { EVERY, IMPROVEMENT };
+
+    static const size_t RING_SIZE = 1 << 14;
+    static const size_t BLOCK_SIZE = 4096;
+
+  private:
+    SpscQueue<EvolutionRecord> ring_;
+    Sampling sampling_;
+    int every_;
+    // print a progress line per record
+    bool echo_;
+    double lastCost_;
+
+    ofstream csv_, binary_;
+    vector<EvolutionRecord> block_;
+    atomic<bool> running_;
+    thread writer_;
+
+    void write();
+    void flushBlock();
+
+  public:
+    Telemetry(const string &csvPath, Sampling = EVERY, int every = 1, const string &binaryPath = "", bool echo = true);
+    // drains the ring and joins the writer
+    ~Telemetry();
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry &operator=(const Telemetry&) = delete;
+
+    // called from the solver thread once per generation
+    void record(int generation, double bestCost, double temperature, int solutionCounter);
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _ZOBRIST_H_
+#define _ZOBRIST_H_
+
+#include "distance_matrix.h"
+#include "node.h"
+
+#include <cstdint>
+
+using namespace std;
+
+// order-independent solution hashing: a node list hashes to the sum of
+// pseudo-random keys of its undirected arcs, so route order and direction
+// do not matter and a moved route updates the sum by its old and new keys
+// depot to depot arcs count 0, empty routes leave the hash alone
+class Zobrist {
+  public:
+    // splitmix64 of the sorted pair stands in for a key table
+    static inline uint64_t arc(customer_t i, customer_t j) {
+        uint64_t lo = i < j ? i : j, hi = i ^ j ^ lo;
+        if (hi == 0) return 0;
+        uint64_t z = (lo << 32 | hi) + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    static inline uint64_t path(const Node *nodes, int n) {
+        uint64_t hash = 0;
+        for (int i = 0; i + 1 < n; ++i)
+            hash += arc(nodes[i].index(), nodes[i + 1].index());
+        return hash;
+    }
+};
+
+#endif
@@ -0,0 +1,282 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _CHECKPOINT_CC_
+#define _CHECKPOINT_CC_
+
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[] = "CVRPCKP1";
+// parts are populations, one per thread, and so are the generator states of a part
+const uint32_t MAX_PARTS = 4096;
+
+// binary writer that remembers the first failure
+struct Writer {
+    FILE *file;
+    bool ok;
+
+    Writer(FILE *file): file(file), ok(file != nullptr) {}
+
+    template <typename T>
+    void put(const T &value) { ok = ok && fwrite(&value, sizeof(T), 1, file) == 1; }
+    template <typename T>
+    void put(const vector<T> &values) {
+        put((uint32_t)values.size());
+        ok = ok && (values.empty() || fwrite(values.data(), sizeof(T), values.size(), file) == values.size());
+    }
+};
+
+// binary reader that exits on a short or inconsistent file
+struct Reader {
+    const char *path;
+    FILE *file;
+
+    template <typename T>
+    void get(T &value) {
+        if (fread(&value, sizeof(T), 1, file) != 1) fail("truncated checkpoint");
+    }
+    template <typename T>
+    void get(vector<T> &values, size_t limit) {
+        uint32_t size;
+        get(size);
+        if (size > limit) fail("corrupt checkpoint");
+        values.resize(size);
+        if (size && fread(values.data(), sizeof(T), size, file) != size) fail("truncated checkpoint");
+    }
+
+    void fail(const char *message) const {
+        fprintf(stderr, "%s: %s\n", path, message);
+        exit(EXIT_FAILURE);
+    }
+};
+
+
+// depot at both ends and every customer exactly once
+bool isSolution(const uint32_t *nodes, size_t n, uint32_t dimension) {
+    if (n < 2 || nodes[0] != 0 || nodes[n - 1] != 0) return false;
+    vector<bool> seen(dimension, false);
+    size_t customers = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (nodes[i] >= dimension) return false;
+        if (nodes[i] == 0) continue;
+        if (seen[nodes[i]]) return false;
+        seen[nodes[i]] = true;
+        ++customers;
+    }
+    return customers + 1 == dimension;
+}
+
+}
+
+Checkpoint::Checkpoint(const string &path, int interval): path_(path), interval_(interval > 0 ? interval : 1), dirty_(false), running_(true) {
+    writer_ = thread(&Checkpoint::write, this);
+}
+
+Checkpoint::~Checkpoint() {
+    {
+        lock_guard<mutex> guard(lock_);
+        running_ = false;
+    }
+    wake_.notify_one();
+    writer_.join();
+}
+
+void Checkpoint::save(const Snapshot &header, int index, int count, Snapshot::Part &&part) {
+    {
+        lock_guard<mutex> guard(lock_);
+        pending_.dimension = header.dimension;
+        pending_.capacity = header.capacity;
+        pending_.seed = header.seed;
+        pending_.elapsed = header.elapsed;
+        pending_.incumbentCost = header.incumbentCost;
+        pending_.incumbent = header.incumbent;
+        if ((int)pending_.parts.size() != count) {
+            pending_.parts.assign(count, Snapshot::Part());
+            arrived_.assign(count, false);
+        }
+        pending_.parts[index] = move(part);
+        arrived_[index] = true;
+        dirty_ = true;
+    }
+    wake_.notify_one();
+}
+
+void Checkpoint::write() {
+    Snapshot snapshot;
+    unique_lock<mutex> guard(lock_);
+    for (;;) {
+        wake_.wait(guard, [this]() { return dirty_ || !running_; });
+        // islands report one by one, wait for a whole population
+        bool complete = dirty_;
+        for (size_t k = 0; k < arrived_.size(); ++k)
+            complete = complete && arrived_[k];
+
+        dirty_ = false;
+        if (complete) {
+            snapshot = pending_;
+            guard.unlock();
+            if (!store(path_, snapshot)) fprintf(stderr, "cannot write checkpoint %s\n", path_.c_str());
+            guard.lock();
+        }
+        // parts handed over during the write are saved before stopping
+        if (!running_ && !dirty_) break;
+    }
+}
+
+bool Checkpoint::store(const string &path, const Snapshot &snapshot) {
+    string temp = path + ".tmp";
+    FILE *file = fopen(temp.c_str(), "wb");
+    Writer out(file);
+    if (!file) return false;
+
+    out.ok = fwrite(MAGIC, 1, 8, file) == 8;
+    out.put(snapshot.dimension);
+    out.put(snapshot.capacity);
+    out.put(snapshot.seed);
+    out.put(snapshot.elapsed);
+    out.put(snapshot.incumbentCost);
+    out.put(snapshot.incumbent);
+    out.put((uint32_t)snapshot.parts.size());
+    for (size_t k = 0; k < snapshot.parts.size(); ++k) {
+        const Snapshot::Part &part = snapshot.parts[k];
+        out.put(part.generation);
+        out.put(part.solutionCounter);
+        out.put(part.lastSolution);
+        out.put(part.temperature);
+        out.put(part.rng);
+        out.put(part.sizes);
+        out.ok = out.ok && (part.nodes.empty() || fwrite(part.nodes.data(), sizeof(uint32_t), part.nodes.size(), file) == part.nodes.size());
+    }
+
+    // the data has to be on disk before the rename makes it current
+    out.ok = out.ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    out.ok = (fclose(file) == 0) && out.ok;
+    if (!out.ok || rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void Checkpoint::load(const string &path, const ProblemInstance &instance, Snapshot &snapshot) {
+    Reader in = { path.c_str(), fopen(path.c_str(), "rb") };
+    if (!in.file) in.fail("cannot open checkpoint");
+
+    char magic[8];
+    if (fread(magic, 1, 8, in.file) != 8 || memcmp(magic, MAGIC, 8) != 0) in.fail("not a checkpoint");
+    in.get(snapshot.dimension);
+    in.get(snapshot.capacity);
+    if (snapshot.dimension != (uint32_t)instance.dimension() || snapshot.capacity != (uint32_t)instance.capacity())
+        in.fail("checkpoint of another instance");
+    in.get(snapshot.seed);
+    in.get(snapshot.elapsed);
+    in.get(snapshot.incumbentCost);
+
+    // a chopped gene holds every customer and at most one depot more than that
+    const size_t limit = 2 * (size_t)snapshot.dimension + 1;
+    in.get(snapshot.incumbent, limit);
+
+    uint32_t parts;
+    in.get(parts);
+    if (parts == 0 || parts > MAX_PARTS) in.fail("corrupt checkpoint");
+    snapshot.parts.resize(parts);
+    for (uint32_t k = 0; k < parts; ++k) {
+        Snapshot::Part &part = snapshot.parts[k];
+        in.get(part.generation);
+        in.get(part.solutionCounter);
+        in.get(part.lastSolution);
+        in.get(part.temperature);
+        in.get(part.rng, 4 * MAX_PARTS);
+        if (part.rng.size() % 4 != 0) in.fail("corrupt checkpoint");
+        in.get(part.sizes, 1 << 24);
+
+        size_t total = 0;
+        for (size_t g = 0; g < part.sizes.size(); ++g) {
+            if (part.sizes[g] > limit) in.fail("corrupt checkpoint");
+            total += part.sizes[g];
+        }
+        part.nodes.resize(total);
+        if (total && fread(part.nodes.data(), sizeof(uint32_t), total, in.file) != total) in.fail("truncated checkpoint");
+        if (part.sizes.empty()) in.fail("corrupt checkpoint");
+        size_t offset = 0;
+        for (size_t g = 0; g < part.sizes.size(); ++g) {
+            if (!isSolution(&part.nodes[offset], part.sizes[g], snapshot.dimension)) in.fail("corrupt checkpoint");
+            offset += part.sizes[g];
+        }
+    }
+    if (!snapshot.incumbent.empty() && !isSolution(snapshot.incumbent.data(), snapshot.incumbent.size(), snapshot.dimension)) 
+        in.fail("corrupt checkpoint");
+    fclose(in.file);
+}
+
+void readSolution(const char *path, const ProblemInstance &instance, vector<Node> &tour) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "cannot open %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    const int dimension = instance.dimension();
+    vector<bool> seen(dimension, false);
+    tour.clear();
+
+    // route lines read 1->a->b->...->1, every other line is skipped
+    char *line = nullptr;
+    size_t length = 0;
+    int lineNumber = 0;
+    while (getline(&line, &length, file) != -1) {
+        ++lineNumber;
+        if (strncmp(line, "1->", 3) != 0) continue;
+        for (char *p = line; *p && *p != '\n'; ) {
+            char *end;
+            long tag = strtol(p, &end, 10);
+            if (end == p) {
+                fprintf(stderr, "%s:%d: node expected\n", path, lineNumber);
+                exit(EXIT_FAILURE);
+            }
+            // the depot and customers the instance does not have are dropped
+            if (tag >= 2 && tag <= dimension && !seen[tag - 1]) {
+                seen[tag - 1] = true;
+                tour.push_back(Node(tag));
+            }
+            p = end;
+            if (p[0] == '-' && p[1] == '>') p += 2;
+            else break;
+        }
+    }
+    free(line);
+    fclose(file);
+
+    // new customers go where they lengthen the tour least, the tour runs between depot visits
+    for (int c = 1; c < dimension; ++c) {
+        if (seen[c]) continue;
+        size_t best = 0;
+        double bestCost = 0;
+        for (size_t k = 0; k <= tour.size(); ++k) {
+            int before = (k > 0)? tour[k - 1].index() : 0;
+            int after = (k < tour.size())? tour[k].index() : 0;
+            double cost = instance.distance(before, c) + instance.distance(c, after) - instance.distance(before, after);
+            if (k == 0 || cost < bestCost) {
+                best = k;
+                bestCost = cost;
+            }
+        }
+        tour.insert(tour.begin() + best, Node(c + 1));
+    }
+}
+
+#endif
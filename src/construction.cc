@@ -0,0 +1,211 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _CONSTRUCTION_CC_
+#define _CONSTRUCTION_CC_
+
+#include "construction.h"
+#include "random.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// per-thread working memory, grown to the largest instance seen
+struct Scratch {
+    // customers by angle and the position of every customer in that order
+    vector<int> order, position;
+    // next unvisited position at or after a position, path-halving skip list
+    vector<int> skip;
+    vector<bool> visited;
+    vector< pair<double, int> > keys;
+    // savings list of (saving, i, j)
+    vector< pair<double, pair<int, int> > > savings;
+    // savings routes as customer lists, route of every customer
+    vector< vector<int> > routes;
+    vector<int> routeOf, load;
+};
+
+Scratch &scratch() {
+    static thread_local Scratch s;
+    return s;
+}
+
+// customers 1..n-1 sorted by key
+void sortCustomers(Scratch &s, int dimension) {
+    sort(s.keys.begin(), s.keys.end());
+    s.order.resize(dimension - 1);
+    s.position.resize(dimension);
+    for (int k = 0; k < dimension - 1; ++k) {
+        s.order[k] = s.keys[k].second;
+        s.position[s.keys[k].second] = k;
+    }
+}
+
+// first unvisited position at or after k, wrapping around, -1 once all are visited
+int nextFree(Scratch &s, int k) {
+    const int m = s.order.size();
+    for (int pass = 0; pass < 2; ++pass) {
+        while (s.skip[k] != k) {
+            s.skip[k] = s.skip[s.skip[k]];
+            k = s.skip[k];
+        }
+        if (k < m) return k;
+        k = 0;
+    }
+    return -1;
+}
+
+}
+
+void Construction::savings(const ProblemInstance &instance, double shape, vector<Node> &tour) {
+    Scratch &s = scratch();
+    const int dimension = instance.dimension(), capacity = instance.capacity();
+    const int k = instance.neighbourCount();
+
+    // every candidate arc once, only merges that save something
+    s.savings.clear();
+    for (int i = 1; i < dimension; ++i) {
+        const customer_t *neighbours = instance.neighbours(i);
+        for (int r = 0; r < k; ++r) {
+            int j = neighbours[r];
+            if (j == 0) continue;
+            double saving = instance.distance(0, i) + instance.distance(0, j) - shape * instance.distance(i, j);
+            // mutual neighbours come twice, the second merge is rejected as a == b
+            if (saving > 0) s.savings.push_back(make_pair(-saving, make_pair(i, j)));
+        }
+    }
+    // largest saving first
+    sort(s.savings.begin(), s.savings.end());
+
+    // one route per customer to begin with
+    s.routes.resize(dimension);
+    s.routeOf.resize(dimension);
+    s.load.resize(dimension);
+    for (int i = 1; i < dimension; ++i) {
+        s.routes[i].assign(1, i);
+        s.routeOf[i] = i;
+        s.load[i] = instance.demand(i);
+    }
+
+    for (int e = 0; e < s.savings.size(); ++e) {
+        int i = s.savings[e].second.first, j = s.savings[e].second.second;
+
+        int a = s.routeOf[i], b = s.routeOf[j];
+        if (a == b || s.load[a] + s.load[b] > capacity) continue;
+        vector<int> &A = s.routes[a], &B = s.routes[b];
+        // both have to end their routes, interior customers are linked already
+        if ((A.front() != i && A.back() != i) || (B.front() != j && B.back() != j)) continue;
+
+        // the longer route absorbs the shorter one, reversing as needed
+        if (A.size() < B.size()) {
+            swap(a, b);
+            swap(i, j);
+        }
+        vector<int> &into = s.routes[a], &from = s.routes[b];
+        if (into.back() != i) reverse(into.begin(), into.end());
+        if (from.front() != j) reverse(from.begin(), from.end());
+        for (int c = 0; c < from.size(); ++c)
+            s.routeOf[from[c]] = a;
+        into.insert(into.end(), from.begin(), from.end());
+        from.clear();
+        s.load[a] += s.load[b];
+    }
+
+    // routes in the angular order of their middle customer, so split sees them as a sweep
+    s.keys.clear();
+    for (int r = 1; r < dimension; ++r)
+        if (!s.routes[r].empty()) s.keys.push_back(make_pair(instance.angle(s.routes[r][s.routes[r].size() / 2]), r));
+    sort(s.keys.begin(), s.keys.end());
+
+    tour.clear();
+    for (int k = 0; k < s.keys.size(); ++k) {
+        const vector<int> &route = s.routes[s.keys[k].second];
+        for (int c = 0; c < route.size(); ++c)
+            tour.push_back(Node(route[c] + 1));
+    }
+}
+
+void Construction::sweep(const ProblemInstance &instance, double jitter, vector<Node> &tour) {
+    Scratch &s = scratch();
+    const int dimension = instance.dimension();
+
+    s.keys.clear();
+    for (int i = 1; i < dimension; ++i)
+        s.keys.push_back(make_pair(instance.angle(i) + jitter * Random::uniformReal(), i));
+    sortCustomers(s, dimension);
+
+    const int m = s.order.size();
+    const int start = Random::uniformInt(0, m);
+    const bool backwards = Random::uniformReal() < 0.5;
+    tour.clear();
+    for (int k = 0; k < m; ++k) {
+        int c = s.order[backwards ? (start - k + m) % m : (start + k) % m];
+        tour.push_back(Node(c + 1));
+    }
+}
+
+void Construction::nearest(const ProblemInstance &instance, double noise, vector<Node> &tour) {
+    Scratch &s = scratch();
+    const int dimension = instance.dimension(), k = instance.neighbourCount();
+
+    s.keys.clear();
+    for (int i = 1; i < dimension; ++i)
+        s.keys.push_back(make_pair(instance.angle(i), i));
+    sortCustomers(s, dimension);
+
+    const int m = s.order.size();
+    s.skip.resize(m + 1);
+    for (int p = 0; p <= m; ++p)
+        s.skip[p] = p;
+    s.visited.assign(dimension, false);
+
+    tour.clear();
+    // start at a random customer
+    int current = s.order[Random::uniformInt(0, m)];
+    for (;;) {
+        s.visited[current] = true;
+        s.skip[s.position[current]] = s.position[current] + 1;
+        tour.push_back(Node(current + 1));
+        if (tour.size() == m) break;
+
+        // the two nearest unvisited candidates
+        int first = -1, second = -1;
+        const customer_t *neighbours = instance.neighbours(current);
+        for (int r = 0; r < k && second < 0; ++r) {
+            int c = neighbours[r];
+            if (c == 0 || s.visited[c]) continue;
+            if (first < 0) first = c;
+            else second = c;
+        }
+        if (first < 0) current = s.order[nextFree(s, s.position[current])];
+        else current = (second >= 0 && Random::uniformReal() < noise)? second : first;
+    }
+}
+
+void Construction::build(Type type, const ProblemInstance &instance, vector<Node> &tour) {
+    switch (type) {
+        case SAVINGS: savings(instance, 0.6 + Random::uniformReal(), tour); break;
+        case NEAREST: nearest(instance, 0.3 * Random::uniformReal(), tour); break;
+        default: sweep(instance, 20 * Random::uniformReal(), tour);
+    }
+}
+
+const char *Construction::name(Type type) {
+    switch (type) {
+        case SAVINGS: return "savings";
+        case NEAREST: return "nearest";
+        default: return "sweep";
+    }
+}
+
+#endif
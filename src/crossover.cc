@@ -0,0 +1,258 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _CROSSOVER_CC_
+#define _CROSSOVER_CC_
+
+#include "crossover.h"
+#include "gene.h"
+#include "node.h"
+#include "utility.h"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#define MIN(a, b) ((a) <= (b)? (a):(b))
+#define DEPOT Node(1)
+
+using namespace std;
+
+namespace {
+
+// per-thread working memory, grown to the largest instance seen
+struct Scratch {
+    // epoch-stamped membership by node index, cleared by bumping the epoch
+    vector<unsigned> stamp;
+    unsigned epoch;
+    // giant tours of both parents
+    vector<Node> tour[2];
+    // ERX edge map, up to 4 distinct neighbours per node
+    vector<int> adjacency;
+    vector<int> degree;
+    // unvisited nodes and their slots, for O(1) removal
+    vector<int> unvisited, slot;
+    // second RBX child
+    Gene spare;
+
+    Scratch(): epoch(0) {}
+
+    // start a new membership set over the nodes of an instance
+    void reset(int dimension) {
+        if ((int)stamp.size() < dimension) stamp.resize(dimension, 0);
+        if (++epoch == 0) {
+            fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+    }
+    inline void mark(int i) { stamp[i] = epoch; }
+    inline bool marked(int i) const { return stamp[i] == epoch; }
+};
+
+Scratch &scratch() {
+    static thread_local Scratch s;
+    return s;
+}
+
+// customers of a chopped gene in order, depots dropped
+void giantTour(const NodeList &nodes, vector<Node> &tour) {
+    tour.clear();
+    for (int i = 0; i < nodes.size(); ++i)
+        if (nodes[i] != DEPOT) tour.push_back(nodes[i]);
+}
+
+// [start, end) of the ith route, start is its opening depot
+void routeBounds(const NodeList &nodes, int ith, int &start, int &end) {
+    int route = 0;
+    start = 0;
+    for (int i = 1; i < nodes.size(); ++i) {
+        if (nodes[i] != DEPOT) continue;
+        if (route++ == ith) {
+            end = i;
+            return;
+        }
+        start = i;
+    }
+    end = nodes.size() - 1;
+}
+
+// remove x from the edge list of y
+inline void unlink(Scratch &s, int y, int x) {
+    int *edges = &s.adjacency[4 * y];
+    for (int k = 0; k < s.degree[y]; ++k) {
+        if (edges[k] == x) {
+            edges[k] = edges[--s.degree[y]];
+            return;
+        }
+    }
+}
+
+inline void link(Scratch &s, int x, int y) {
+    int *edges = &s.adjacency[4 * x];
+    for (int k = 0; k < s.degree[x]; ++k)
+        if (edges[k] == y) return;
+    edges[s.degree[x]++] = y;
+}
+
+}
+
+// child = route ith of the donor, then the receiver without the donor's customers
+// the receiver keeps its depots, emptied routes are compacted away
+void Crossover::rbx(const Gene &a, const Gene &b, Gene &child) const {
+    Scratch &s = scratch();
+    const int dimension = a.instance_->dimension();
+
+    // the last route of b is never donated
+    int ith = generateRandom(0, MIN(a.routes(), b.routes() - 1));
+
+    Gene *kids[2] = { &child, &s.spare };
+    const Gene *donors[2] = { &b, &a };
+    const Gene *receivers[2] = { &a, &b };
+    for (int k = 0; k < 2; ++k) {
+        Gene &kid = *kids[k];
+        const NodeList &donor = donors[k]->nodes_;
+        int start, end;
+        if (donors[k]->indexed_) {
+            start = donors[k]->routeBegin(ith);
+            end = donors[k]->routeEnd(ith);
+        } else routeBounds(donor, ith, start, end);
+
+        s.reset(dimension);
+        kid.nodes_.clear();
+        for (int i = start; i < end; ++i) {
+            kid.nodes_.push_back(donor[i]);
+            s.mark(donor[i].index());
+        }
+
+        const NodeList &receiver = receivers[k]->nodes_;
+        for (int i = 0; i < receiver.size(); ++i)
+            if (receiver[i] == DEPOT || !s.marked(receiver[i].index()))
+                kid.nodes_.push_back(receiver[i]);
+
+        // routes only lose customers, so the kid stays feasible
+        kid.instance_ = a.instance_;
+        kid.update();
+        kid.compact();
+#ifdef CVRP_DEBUG
+        assert(kid.validate());
+#endif
+    }
+
+    // copied rather than swapped, the thread's spare must never hold an arena slot
+    if (!(child.cost() < s.spare.cost())) child = s.spare;
+}
+
+// order crossover: a random slice of a keeps its positions,
+// the rest follows b's order from the end of the slice
+void Crossover::ox(const Gene &a, const Gene &b, Gene &child) const {
+    Scratch &s = scratch();
+    giantTour(a.nodes_, s.tour[0]);
+    giantTour(b.nodes_, s.tour[1]);
+    const vector<Node> &ta = s.tour[0], &tb = s.tour[1];
+    const int n = ta.size();
+
+    int first = generateRandom(0, n), last = generateRandom(0, n);
+    if (first > last) swap(first, last);
+    ++last;
+
+    s.reset(a.instance_->dimension());
+    child.nodes_.assign(n, DEPOT);
+    for (int i = first; i < last; ++i) {
+        child.nodes_[i] = ta[i];
+        s.mark(ta[i].index());
+    }
+
+    int fill = last % n;
+    for (int k = 0; k < n; ++k) {
+        const Node &node = tb[(last + k) % n];
+        if (s.marked(node.index())) continue;
+        child.nodes_[fill] = node;
+        fill = (fill + 1) % n;
+    }
+
+    child.instance_ = a.instance_;
+    child.chop();
+}
+
+// edge recombination: follow parent edges, preferring the neighbour
+// with the fewest remaining edges, jump to a random node when stuck
+void Crossover::erx(const Gene &a, const Gene &b, Gene &child) const {
+    Scratch &s = scratch();
+    const int dimension = a.instance_->dimension();
+    giantTour(a.nodes_, s.tour[0]);
+    giantTour(b.nodes_, s.tour[1]);
+    const int n = s.tour[0].size();
+
+    s.adjacency.resize(4 * dimension);
+    s.degree.assign(dimension, 0);
+    for (int t = 0; t < 2; ++t) {
+        const vector<Node> &tour = s.tour[t];
+        for (int i = 0; i < n; ++i) {
+            int x = tour[i].index(), y = tour[(i + 1) % n].index();
+            link(s, x, y);
+            link(s, y, x);
+        }
+    }
+
+    s.unvisited.resize(n);
+    s.slot.resize(dimension);
+    for (int i = 0; i < n; ++i) {
+        s.unvisited[i] = s.tour[0][i].index();
+        s.slot[s.unvisited[i]] = i;
+    }
+
+    child.nodes_.clear();
+    int current = s.tour[0][0].index();
+    for (int remaining = n; remaining > 0; --remaining) {
+        child.nodes_.push_back(Node(current + 1));
+
+        // drop current from the unvisited set and from every edge list
+        int last = s.unvisited[remaining - 1];
+        s.unvisited[s.slot[current]] = last;
+        s.slot[last] = s.slot[current];
+        const int *edges = &s.adjacency[4 * current];
+        for (int k = 0; k < s.degree[current]; ++k)
+            unlink(s, edges[k], current);
+        if (remaining == 1) break;
+
+        int next = -1;
+        for (int k = 0; k < s.degree[current]; ++k)
+            if (next < 0 || s.degree[edges[k]] < s.degree[next]) next = edges[k];
+        current = (next >= 0)? next : s.unvisited[(int)generateRandom(0, remaining - 1)];
+    }
+
+    child.instance_ = a.instance_;
+    child.chop();
+}
+
+void Crossover::operator()(const Gene &a, const Gene &b, Gene &child) const {
+    switch (type_) {
+        case OX: ox(a, b, child); break;
+        case ERX: erx(a, b, child); break;
+        default: rbx(a, b, child);
+    }
+}
+
+bool Crossover::parse(const string &name, Type &type) {
+    if (name == "rbx") type = RBX;
+    else if (name == "ox") type = OX;
+    else if (name == "erx") type = ERX;
+    else return false;
+    return true;
+}
+
+const char *Crossover::name(Type type) {
+    switch (type) {
+        case OX: return "ox";
+        case ERX: return "erx";
+        default: return "rbx";
+    }
+}
+
+#endif
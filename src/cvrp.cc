@@ -9,175 +9,485 @@
 #ifndef _CVRP_CC_
 #define _CVRP_CC_
 
+#include "construction.h"
 #include "cvrp.h"
 #include "gene.h"
 #include "node.h"
+#include "profiler.h"
+#include "random.h"
 #include "utility.h"
 
 #include <algorithm>
 // #include <chrono>
 #include <cmath>
-#include <fstream>
+#include <memory>
 #include <omp.h>
 #include <vector>
 
 using namespace std;
 // using namespace std::chrono;
 
-int CVRP::dimension_ = 0;
+namespace {
 
-void CVRP::generateGenes() {
-    // sort all customer nodes by angles to the depot
-    vector<Node> nodes;
-    for (int i = 1; i < dimension_; ++i) 
-        nodes.push_back(Node(i + 1)); 
-    
-    sort(nodes.begin(), nodes.end(), [=](const Node &i, const Node &j){ return i.angle() < j.angle(); });
-
-    for (int j = 0; j < numOfGenes_ / 2 + 1; ++j) {
-        vector<Node> temp(nodes);
-        // clustering by angle
-        int initialAngle = (dimension_ - 1) / numOfGenes_ * j;
-        rotate(temp.begin(), temp.begin() + initialAngle, temp.end());
-        Gene g1(temp);
-        
-        random_shuffle(temp.begin(), temp.end());
-        Gene g2(temp);
+// genes of a snapshot part, appended to genes
+void genesOf(const ProblemInstance *instance, const Snapshot::Part &part, vector<Gene> &genes) {
+    size_t offset = 0;
+    for (size_t g = 0; g < part.sizes.size(); ++g) {
+        vector<Node> nodes;
+        for (uint32_t k = 0; k < part.sizes[g]; ++k) 
+            nodes.push_back(Node(part.nodes[offset + k] + 1));
+        offset += part.sizes[g];
+        genes.push_back(Gene(instance, nodes));
+    }
+}
+
+// generator states of the threads evolving a population, or of the calling thread alone
+void saveGenerators(bool parallel, vector<uint64_t> &rng) {
+    if (!parallel) {
+        rng.resize(4);
+        Random::engine().state(rng.data());
+        return;
+    }
+    rng.assign(4 * omp_get_max_threads(), 0);
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        if (4 * t + 4 <= rng.size()) Random::engine().state(&rng[4 * t]);
+    }
+}
+
+// threads beyond the saved ones keep the streams of the snapshot's seed
+void loadGenerators(bool parallel, const vector<uint64_t> &rng) {
+    if (!parallel) {
+        if (rng.size() >= 4) Random::engine().setState(rng.data());
+        return;
+    }
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        if (4 * t + 4 <= rng.size()) Random::engine().setState(&rng[4 * t]);
+    }
+}
+
+}
 
-        genes_.push_back(g1);
-        genes_.push_back(g2);
+void CVRP::generateGenes() {
+    Profiler::Scope scope(Profiler::CONSTRUCTION);
+    const ProblemInstance *instance = instance_.get();
+    
+    // savings, nearest neighbour and two sweeps in turn, each thread takes
+    // a block holding the same mix, every tour is split into routes right away
+    static const Construction::Type mix[] = { Construction::SAVINGS, Construction::NEAREST, Construction::SWEEP, Construction::SWEEP };
+    genes_.clear();
+    genes_.resize(numOfGenes_);
+    #pragma omp parallel for schedule(static) if(parallel_)
+    for (int k = 0; k < numOfGenes_; ++k) {
+        vector<Node> tour;
+        Construction::build(mix[k % 4], *instance, tour);
+        genes_[k] = Gene(instance, tour);
+        genes_[k].chop();
     }
 
     sortByCost();
     lastSolution_ = genes_[0].cost();
     
-    // adding depots to the routes
-    for (int k = 0; k < genes_.size(); ++k) 
-        genes_[k].chop();
+    // the prior solution and mutated copies of it replace the worst tenth
+    if (!warmStart_.empty()) {
+        Gene warm(instance, warmStart_);
+        warm.chop();
+        int copies = min(max(numOfGenes_ / 10, 1), (int)genes_.size());
+        for (int k = 0; k < copies; ++k) {
+            Gene &gene = genes_[genes_.size() - 1 - k];
+            gene = warm;
+            if (k > 0) gene.sequentialMutate(1.0, temperature_);
+        }
+        sortByCost();
+    }
+    
+    bindPopulation();
+}
+
+void CVRP::bindPopulation() {
+    const int n = genes_.size();
+    population_.allocate(2 * n, instance_->dimension());
+    offspring_.resize(n);
+    
+    for (int k = 0; k < n; ++k) {
+        genes_[k].place(population_.slot(k), population_.stride());
+        offspring_[k].place(population_.slot(n + k), population_.stride());
+    }
 }
 
 void CVRP::crossover(const double &crossoverRate) {
     vector<int> selected = selectByCost();
+    const int pairs = selected.size() / 2;
+    if (offspring_.size() < selected.size()) offspring_.resize(selected.size());
     
-    #pragma omp parallel for
-    for (int i = 0; i < selected.size() - 1; i += 2) {
-        int p = selected[i];
-        int q = selected[i + 1];
+    hashes_.resize(numOfGenes_);
+    for (int k = 0; k < numOfGenes_; ++k) 
+        hashes_[k] = genes_[k].hash();
+    sort(hashes_.begin(), hashes_.end());
+    
+    // parents are only read here, so a gene drawn by several pairs is safe
+    #pragma omp parallel for schedule(static) if(parallel_)
+    for (int i = 0; i < pairs; ++i) {
+        int p = selected[2 * i];
+        int q = selected[2 * i + 1];
+        Gene &daughter = offspring_[2 * i], &son = offspring_[2 * i + 1];
         
-        Gene daughter(genes_[q].Rbx(genes_[p], crossoverRate));
-        Gene son(genes_[p].Rbx(genes_[q], crossoverRate));
+        if (generateRandom() < crossoverRate) breed(genes_[q], genes_[p], daughter);
+        else daughter = genes_[q];
+        if (generateRandom() < crossoverRate) breed(genes_[p], genes_[q], son);
+        else son = genes_[p];
+    
+        // the chosen child goes first
+        if (son.cost() < daughter.cost()) swap(daughter, son);
+        if (memetic_) {
+            Profiler::Scope scope(Profiler::LOCAL_SEARCH);
+            if (localSearch_(daughter) < 0) Profiler::count(Profiler::LOCAL_SEARCH, Profiler::IMPROVED);
+        }
+    }
     
-        if (genes_[p].cost() < genes_[q].cost()) genes_[q] = genes_[p];
-        else genes_[p] = genes_[q];
+    for (int i = 0; i < pairs; ++i) {
+        int p = selected[2 * i];
+        int q = selected[2 * i + 1];
+        Gene &child = offspring_[2 * i];
         
-        if (son.cost() < daughter.cost()) genes_[q] = son;
-        else genes_[q] = daughter;
+        // keep the better parent at p, the child replaces the other one
+        // clones would only be mutated again, so the worse parent stays instead
+        if (binary_search(hashes_.begin(), hashes_.end(), child.hash())) continue;
+        hashes_.insert(upper_bound(hashes_.begin(), hashes_.end(), child.hash()), child.hash());
+        if (genes_[q].cost() < genes_[p].cost()) swap(genes_[p], genes_[q]);
+        // the replaced gene's storage goes back to the offspring pool
+        swap(genes_[q], child);
+        Profiler::count(Profiler::CROSSOVER, Profiler::ACCEPTED);
     }
 }
 
+void CVRP::breed(const Gene &a, const Gene &b, Gene &child) const {
+    Profiler::Scope scope(Profiler::CROSSOVER);
+    crossover_(a, b, child);
+    if (child.cost() < min(a.cost(), b.cost())) Profiler::count(Profiler::CROSSOVER, Profiler::IMPROVED);
+}
+
 vector<int> CVRP::selectByCost() {
-    vector<int> index;
-    vector<double> costList;
-    double totalCost = 0, accumulatCost = 0;
-    // calculate total cost and record every cost in the codeList 
-    for (int i = 0; i < numOfGenes_; ++i) {
-        costList.push_back(genes_[i].cost());
-        totalCost += costList[i];
-    }
+    Profiler::Scope scope(Profiler::SELECTION);
+    selection_.prepare(genes_.data(), numOfGenes_);
     
-    // use accumulatCost to calculate accumulative probability
-    for (int j = numOfGenes_ - 1; j >= 0; --j) {
-        accumulatCost += costList[j];
-
-        if (generateRandom() < accumulatCost / totalCost) {
-            index.push_back(j);
-        }
-    }
+    // a quarter of the population in pairs, a fixed and even workload
+    vector<int> index(2 * max(numOfGenes_ / 4, 1));
+    for (int k = 0; k < index.size(); k += 2) 
+        selection_.pair(index[k], index[k + 1]);
     
     return index;     
 }
 
-void CVRP::sortByCost() { sort(genes_.begin(), genes_.end(), [=](const Gene &i, const Gene &j){ return i.cost() < j.cost(); }); }
+void CVRP::sortByCost() { 
+    Profiler::Scope scope(Profiler::SORT);
+    sort(genes_.begin(), genes_.end(), [=](const Gene &i, const Gene &j){ return i.cost() < j.cost(); }); 
+}
 
-void CVRP::exportEvolutionData(int generation, double temperature) {
-    static bool first_write = true;
-    ofstream outfile;
+void CVRP::run() {
+    
+    incumbent_->start();
+    
+    cache_ = make_shared<FitnessCache>();
+    localSearch_.setCache(cache_);
+    
+    if (resume_) restore();
+    else generateGenes();
+    
+    evolve();
+}
 
-    if (first_write) {
-        outfile.open("evolution_data.csv", ios::out);
-        outfile << "generation,best_cost,temperature,solution_counter\n";
-        first_write = false;
-    } else {
-        outfile.open("evolution_data.csv", ios::app);
+void CVRP::restore() {
+    const Snapshot &snapshot = *resume_;
+    
+    // the seed of the run that wrote the snapshot, not the one of this
+    // process, so threads without a saved stream continue alike
+    Random::seed(snapshot.seed);
+    
+    genes_.clear();
+    for (size_t k = 0; k < snapshot.parts.size(); ++k) 
+        genesOf(instance_.get(), snapshot.parts[k], genes_);
+    numOfGenes_ = genes_.size();
+    sortByCost();
+    
+    // islands resumed as islands take their own counters in evolveIslands()
+    const Snapshot::Part &part = snapshot.parts[0];
+    firstGeneration_ = part.generation;
+    solutionCounter_ = part.solutionCounter;
+    lastSolution_ = part.lastSolution;
+    elapsedBefore_ = snapshot.elapsed;
+    if (snapshot.parts.size() == 1) loadGenerators(parallel_, part.rng);
+    
+    if (!snapshot.incumbent.empty()) {
+        vector<Node> nodes;
+        for (size_t k = 0; k < snapshot.incumbent.size(); ++k) 
+            nodes.push_back(Node(snapshot.incumbent[k] + 1));
+        incumbent_->offer(Gene(instance_.get(), nodes));
     }
+    
+    bindPopulation();
+}
 
-    outfile << generation << "," << genes_[0].cost() << "," << temperature << "," << solutionCounter_ << "\n";
-    outfile.close();
+void CVRP::checkpoint(int generation, double temperature) {
+    Snapshot::Part part;
+    part.generation = generation;
+    part.solutionCounter = solutionCounter_;
+    part.lastSolution = lastSolution_;
+    part.temperature = temperature;
+    for (int k = 0; k < numOfGenes_; ++k) {
+        const NodeList &nodes = genes_[k].nodes();
+        part.sizes.push_back(nodes.size());
+        for (int i = 0; i < nodes.size(); ++i) 
+            part.nodes.push_back(nodes[i].index());
+    }
+    saveGenerators(parallel_, part.rng);
+    
+    Snapshot header;
+    header.dimension = instance_->dimension();
+    header.capacity = instance_->capacity();
+    header.seed = Random::seed();
+    header.elapsed = elapsedBefore_ + incumbent_->elapsed();
+    header.incumbentCost = incumbent_->cost();
+    Gene best = incumbent_->get();
+    for (int i = 0; i < best.nodes().size(); ++i) 
+        header.incumbent.push_back(best.nodes()[i].index());
+    
+    // the writer thread takes it from here
+    checkpoint_->save(header, part_, parts_, move(part));
 }
 
 void CVRP::solve() {
 
-    generateGenes();
+    run();
 
-    evolve();
+    // flush the evolution data before the solution is printed
+    telemetry_.reset();
 
     genes_[0].print();
 }
 
+double CVRP::step(int i) {
+    Profiler::Scope scope(Profiler::GENERATION);
+    
+    // update solutionCounter and the last solution cost
+    if (lastSolution_ == genes_[0].cost()) { 
+        ++solutionCounter_;
+    } else {
+        lastSolution_ = genes_[0].cost(); 
+        solutionCounter_ = 0;
+    }
+    
+    // adapt crossover mutation rate based on solution repetition
+    double crossoverRate = crossoverRate_ * exp(- 100 * solutionCounter_ / (double)numOfGenerations_);
+    double mutationRate = mutationRate_ + solutionCounter_ / (double)numOfGenerations_ * (1 - mutationRate_);
+    double temperature = temperature_ - progress(i) * temperature_;
+    
+    // select and crossover
+    crossover(crossoverRate);
+    
+    genes_[numOfGenes_ - 1] = genes_[0];
+    
+    #pragma omp parallel for schedule(static) if(parallel_)
+    for (int m = 1; m < genes_.size(); ++m) {
+        genes_[m].sequentialMutate(mutationRate, temperature);
+        genes_[m].optMutation(mutationRate);
+    }
+    
+    // rescore the population in one batch, dropping the rounding drift of the move deltas
+    {
+        Profiler::Scope scope(Profiler::EVALUATE);
+        Gene::evaluate(genes_.data(), genes_.size());
+    }
+
+    sortByCost();
+    
+    return temperature;
+}
+
 // evolve with chopped genes
 void CVRP::evolve() {
     
-    double crossoverRate, mutationRate;
-    double temperature = temperature_;
+    if (islands_ > 1) {
+        evolveIslands();
+        return;
+    }
     
-    // high_resolution_clock::time_point t1 = high_resolution_clock::now();
+    double best = incumbent_->cost(), temperature = temperature_;
+    int stagnant = 0;
     
-    for (int i = 0; i < numOfGenerations_; ++i) {
-        
-        // update solutionCounter and the last solution cost
-        if (lastSolution_ == genes_[0].cost()) { 
-            ++solutionCounter_;
-        } else {
-            lastSolution_ = genes_[0].cost(); 
-            solutionCounter_ = 0;
-        }
+    for (generationsRun_ = firstGeneration_; !finished(generationsRun_, stagnant); ++generationsRun_) {
+        int i = generationsRun_;
         
-        // adapt crossover mutation rate based on solution repetition
-        crossoverRate = crossoverRate_ * exp(- 100 * solutionCounter_ / (double)numOfGenerations_);
-        mutationRate = mutationRate_ + solutionCounter_ / (double)numOfGenerations_ * (1 - mutationRate_);
-        temperature = temperature_ - i * temperature_ / (double)numOfGenerations_;
+        temperature = step(i);
         
-        // select and crossover
-        crossover(crossoverRate);
-        
-        genes_[numOfGenes_ - 1] = genes_[0];
-        
-        #pragma omp parallel for        
-        for (int m = 1; m < genes_.size(); ++m) {
-            genes_[m].sequentialMutate(mutationRate, temperature);
-            genes_[m].optMutation(mutationRate);
-        }
-
-        sortByCost();
+        incumbent_->offer(genes_[0]);
+        stagnant = (incumbent_->cost() < best)? 0 : stagnant + 1;
+        best = incumbent_->cost();
 
         // Export data for visualization
-        exportEvolutionData(i + 1, temperature);
+        if (telemetry_) telemetry_->record(i + 1, genes_[0].cost(), temperature, solutionCounter_);
+        
+        if (checkpoint_ && (i + 1) % checkpoint_->interval() == 0) checkpoint(i + 1, temperature);
+        Profiler::poll();
+    }
+    
+    if (checkpoint_) checkpoint(generationsRun_, temperature);
+}
 
-        /******************************************************************
-         *Timer use
+double CVRP::progress(int i) const {
+    double progress = i / (double)numOfGenerations_;
+    if (stopping_.timeBudget > 0) progress = max(progress, incumbent_->elapsed() / stopping_.timeBudget);
+    return min(progress, 1.0);
+}
 
-        high_resolution_clock::time_point t2 = high_resolution_clock::now();
-        duration<double> time_span = duration_cast<duration<double>>(t2 - t1);
+bool CVRP::finished(int generation, int stagnant) const {
+    int generations = (stopping_.generations > 0)? stopping_.generations : numOfGenerations_;
+    
+    return generation >= generations 
+        || incumbent_->stopped() 
+        || (stopping_.timeBudget > 0 && incumbent_->elapsed() >= stopping_.timeBudget) 
+        || (stopping_.stagnation > 0 && stagnant >= stopping_.stagnation) 
+        || (stopping_.targetCost > 0 && incumbent_->cost() <= stopping_.targetCost);
+}
 
-        if (time_span.count() > 1700) break;
-         ********************************
-         *           debugging
-         ********************************/
-        printf("generation %d temperature: %.3f, cost: %.3f\n", i + 1, temperature, lastSolution_);
+void CVRP::migrate(int i) {
+    Profiler::Scope scope(Profiler::MIGRATION);
+    // immigrants replace the worst genes, the elite stays
+    int received = 0;
+    while (received < migrants_ && numOfGenes_ - 1 - received > 0 && inbox_->pop(genes_[numOfGenes_ - 1 - received])) 
+        ++received;
+    if (received) sortByCost();
+    Profiler::count(Profiler::MIGRATION, Profiler::ACCEPTED, received);
+    
+    // send elites every interval, or early once the island stagnates
+    if ((i + 1) % migrationInterval_ == 0 || solutionCounter_ == migrationInterval_ / 2) {
+        for (int m = 0; m < migrants_ && m < numOfGenes_; ++m) 
+            outbox_->push(genes_[m]);
     }
+}
+
+void CVRP::evolveIslands() {
+    vector<CVRP> islands;
+    vector< unique_ptr< SpscQueue<Gene> > > queues;
     
+    #pragma omp parallel num_threads(islands_)
+    {
+        #pragma omp single
+        {
+            // one island per thread actually granted, at least 2 genes each
+            int k = min(omp_get_num_threads(), (int)genes_.size() / 2);
+            
+            for (int t = 0; t < k; ++t) {
+                islands.push_back(CVRP(instance_, 0, numOfGenerations_, crossoverRate_, mutationRate_, temperature_));
+                queues.push_back(unique_ptr< SpscQueue<Gene> >(new SpscQueue<Gene>(2 * migrants_)));
+            }
+            
+            // a snapshot of as many islands gives every island its own part back,
+            // otherwise the sorted population is dealt round robin so every island gets elites
+            bool resumed = resume_ && resume_->parts.size() == k;
+            if (resumed) {
+                for (int t = 0; t < k; ++t) 
+                    genesOf(instance_.get(), resume_->parts[t], islands[t].genes_);
+            } else {
+                for (int g = 0; g < genes_.size(); ++g) 
+                    islands[g % k].genes_.push_back(genes_[g]);
+            }
+            
+            for (int t = 0; t < k; ++t) {
+                CVRP &island = islands[t];
+                island.numOfGenes_ = island.genes_.size();
+                island.sortByCost();
+                island.lastSolution_ = island.genes_[0].cost();
+                island.solutionCounter_ = solutionCounter_;
+                island.firstGeneration_ = firstGeneration_;
+                if (resumed) {
+                    island.lastSolution_ = resume_->parts[t].lastSolution;
+                    island.solutionCounter_ = resume_->parts[t].solutionCounter;
+                    island.firstGeneration_ = resume_->parts[t].generation;
+                }
+                island.migrationInterval_ = migrationInterval_;
+                island.migrants_ = migrants_;
+                island.parallel_ = false;
+                island.inbox_ = queues[t].get();
+                island.outbox_ = queues[(t + 1) % k].get();
+                island.stopping_ = stopping_;
+                island.crossover_ = crossover_;
+                island.selection_ = selection_;
+                island.localSearch_ = localSearch_;
+                island.memetic_ = memetic_;
+                island.incumbent_ = incumbent_;
+                island.cache_ = cache_;
+                island.checkpoint_ = checkpoint_;
+                island.part_ = t;
+                island.parts_ = k;
+                island.elapsedBefore_ = elapsedBefore_;
+            }
+        }
+        
+        int t = omp_get_thread_num();
+        if (t < islands.size()) {
+            CVRP &island = islands[t];
+            // the island's own arena, first touched by the thread using it
+            island.bindPopulation();
+            if (resume_ && resume_->parts.size() == islands.size()) loadGenerators(false, resume_->parts[t].rng);
+            double best = incumbent_->cost(), temperature = temperature_;
+            int stagnant = 0;
+            
+            // every island sees the same incumbent, so any of them
+            // meeting a criterion stops them all
+            for (island.generationsRun_ = island.firstGeneration_; !island.finished(island.generationsRun_, stagnant); ++island.generationsRun_) {
+                int i = island.generationsRun_;
+                temperature = island.step(i);
+                island.migrate(i);
+                
+                incumbent_->offer(island.genes_[0]);
+                stagnant = (incumbent_->cost() < best)? 0 : stagnant + 1;
+                best = incumbent_->cost();
+                
+                // the first island reports the best cost over all islands
+                if (t == 0 && telemetry_) telemetry_->record(i + 1, best, temperature, island.solutionCounter_);
+                
+                // islands hand over their parts on their own, the writer waits for all of them
+                if (checkpoint_ && (i + 1) % checkpoint_->interval() == 0) island.checkpoint(i + 1, temperature);
+                if (t == 0) Profiler::poll();
+            }
+            incumbent_->stop();
+            if (checkpoint_) island.checkpoint(island.generationsRun_, temperature);
+        }
+    }
+    
+    // copy back into the master arena, the island arenas go with the islands
+    generationsRun_ = 0;
+    int g = 0;
+    for (int t = 0; t < islands.size(); ++t) {
+        generationsRun_ = max(generationsRun_, islands[t].generationsRun_);
+        for (int m = 0; m < islands[t].genes_.size(); ++m) 
+            genes_[g++] = islands[t].genes_[m];
+    }
+    sortByCost();
 }
 
-void CVRP::setDimension(const int &dimension) { dimension_ = dimension; }
+void CVRP::setIslands(int islands, int migrationInterval, int migrants) {
+    islands_ = islands;
+    migrationInterval_ = max(migrationInterval, 1);
+    migrants_ = max(migrants, 1);
+}
+
+vector<Gene> CVRP::solveBatch(const vector< shared_ptr<const ProblemInstance> > &instances, int numOfGenes, int numOfGenerations, double crossoverRate, double mutationRate, double temperature) {
+    vector<Gene> best(instances.size());
+    
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int k = 0; k < instances.size(); ++k) {
+        CVRP cvrp(instances[k], numOfGenes, numOfGenerations, crossoverRate, mutationRate, temperature);
+        cvrp.parallel_ = false;
+        cvrp.run();
+        best[k] = cvrp.best();
+    }
+    
+    return best;
+}
 
 #endif 
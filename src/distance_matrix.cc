@@ -0,0 +1,162 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _DISTANCE_MATRIX_CC_
+#define _DISTANCE_MATRIX_CC_
+
+#include "distance_matrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+const size_t DistanceMatrix::ALIGNMENT;
+const size_t DistanceMatrix::SQUARE_LIMIT;
+const size_t DistanceMatrix::TABLE_LIMIT;
+
+// TSPLIB nearest integer
+static inline double nint(double d) { return (double)(long long)(d + 0.5); }
+
+template <DistanceMatrix::Metric metric>
+static inline double weight(double dx, double dy) {
+    switch (metric) {
+        case DistanceMatrix::EUC_2D: return nint(sqrt(dx * dx + dy * dy));
+        case DistanceMatrix::CEIL_2D: return ceil(sqrt(dx * dx + dy * dy));
+        case DistanceMatrix::ATT: {
+            // pseudo-euclidean distance of the att instances
+            double r = sqrt((dx * dx + dy * dy) / 10.0);
+            double t = nint(r);
+            return (t < r)? t + 1 : t;
+        }
+        case DistanceMatrix::MAN_2D: return nint(fabs(dx) + fabs(dy));
+        case DistanceMatrix::MAX_2D: return max(nint(fabs(dx)), nint(fabs(dy)));
+        default: return sqrt(dx * dx + dy * dy);
+    }
+}
+
+// one row of the lower triangle, the metric is fixed so the loop vectorizes
+template <DistanceMatrix::Metric metric>
+static void fillRow(distance_t *r, const double *x, const double *y, size_t i) {
+    for (size_t j = 0; j <= i; ++j)
+        r[j] = (distance_t)weight<metric>(x[i] - x[j], y[i] - y[j]);
+}
+
+double DistanceMatrix::weight(Metric metric, double dx, double dy) {
+    switch (metric) {
+        case EUC_2D: return ::weight<EUC_2D>(dx, dy);
+        case CEIL_2D: return ::weight<CEIL_2D>(dx, dy);
+        case ATT: return ::weight<ATT>(dx, dy);
+        case MAN_2D: return ::weight<MAN_2D>(dx, dy);
+        case MAX_2D: return ::weight<MAX_2D>(dx, dy);
+        default: return ::weight<EXACT>(dx, dy);
+    }
+}
+
+distance_t DistanceMatrix::compute(size_t i, size_t j) const {
+    double dx = x_[i] - x_[j], dy = y_[i] - y_[j];
+    return (distance_t)((metric_ == EXACT)? sqrt(dx * dx + dy * dy) : weight(metric_, dx, dy));
+}
+
+void DistanceMatrix::allocate(size_t dimension, Layout layout) {
+    dimension_ = dimension;
+    if (dimension_ - 1 > (size_t)(customer_t)-1) {
+        fprintf(stderr, "dimension %zu exceeds the customer index range, rebuild with CVRP_WIDE_INDEX\n", dimension_);
+        exit(EXIT_FAILURE);
+    }
+    x_.clear();
+    y_.clear();
+
+    if (layout == AUTO) layout = (dimension_ <= SQUARE_LIMIT)? SQUARE:TRIANGULAR;
+    layout_ = layout;
+    if (layout_ == ON_DEMAND) {
+        stride_ = 0;
+        row_.clear();
+        data_.reset();
+        return;
+    }
+
+    // pad square rows to whole cache lines
+    const size_t perLine = ALIGNMENT / sizeof(distance_t);
+    stride_ = (dimension_ + perLine - 1) / perLine * perLine;
+
+    row_.resize(dimension_);
+    for (size_t i = 0; i < dimension_; ++i)
+        row_[i] = (layout_ == SQUARE)? i * stride_ : i * (i + 1) / 2;
+    size_t size = bytes() / sizeof(distance_t);
+
+    void *p = nullptr;
+    if (posix_memalign(&p, ALIGNMENT, (size ? size : 1) * sizeof(distance_t)) != 0) throw bad_alloc();
+    data_.reset(static_cast<distance_t*>(p));
+}
+
+void DistanceMatrix::mirror() {
+    if (layout_ != SQUARE) return;
+
+    // mirror the lower triangle and zero the padding
+    for (size_t i = 0; i < dimension_; ++i) {
+        distance_t *r = data_.get() + row_[i];
+        for (size_t j = i + 1; j < dimension_; ++j)
+            r[j] = data_[row_[j] + i];
+        for (size_t j = dimension_; j < stride_; ++j)
+            r[j] = 0;
+    }
+}
+
+void DistanceMatrix::build(const vector<double> &x, const vector<double> &y, Metric metric, Layout layout) {
+    if (layout == ON_DEMAND) {
+        allocate(x.size(), ON_DEMAND);
+        x_ = x;
+        y_ = y;
+        metric_ = metric;
+        return;
+    }
+    allocate(x.size(), layout);
+    metric_ = metric;
+
+    void (*fill)(distance_t*, const double*, const double*, size_t);
+    switch (metric) {
+        case EUC_2D: fill = fillRow<EUC_2D>; break;
+        case CEIL_2D: fill = fillRow<CEIL_2D>; break;
+        case ATT: fill = fillRow<ATT>; break;
+        case MAN_2D: fill = fillRow<MAN_2D>; break;
+        case MAX_2D: fill = fillRow<MAX_2D>; break;
+        default: fill = fillRow<EXACT>;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (size_t i = 0; i < dimension_; ++i)
+        fill(data_.get() + row_[i], x.data(), y.data(), i);
+
+    mirror();
+}
+
+void DistanceMatrix::build(size_t dimension, const vector<double> &lower, Layout layout) {
+    // explicit weights have no coordinates to compute from
+    allocate(dimension, (layout == ON_DEMAND)? AUTO : layout);
+
+    for (size_t i = 0; i < dimension_; ++i) {
+        distance_t *r = data_.get() + row_[i];
+        const double *w = &lower[i * (i + 1) / 2];
+        for (size_t j = 0; j <= i; ++j)
+            r[j] = (distance_t)w[j];
+    }
+
+    mirror();
+}
+
+size_t DistanceMatrix::bytes() const {
+    if (layout_ == ON_DEMAND) return 2 * dimension_ * sizeof(double);
+    return ((layout_ == SQUARE)? dimension_ * stride_ : dimension_ * (dimension_ + 1) / 2) * sizeof(distance_t);
+}
+
+#endif
@@ -0,0 +1,224 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _FITNESS_CC_
+#define _FITNESS_CC_
+
+#include "fitness.h"
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CVRP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static_assert(sizeof(Node) == sizeof(customer_t), "node lists are read as raw customer indices");
+
+namespace {
+
+const int LANES = 8;
+
+// matrix geometry seen by the kernels
+struct Matrix {
+    const distance_t *data;
+    size_t stride;
+    bool square;
+
+    Matrix(const DistanceMatrix &m): data(m.data()), stride(m.stride()), square(m.layout() == DistanceMatrix::SQUARE) {}
+
+    inline double operator()(size_t i, size_t j) const {
+        size_t lo = i < j ? i : j;
+        size_t hi = i ^ j ^ lo;
+        return data[square ? hi * stride + lo : hi * (hi + 1) / 2 + lo];
+    }
+};
+
+// distances of an ON_DEMAND matrix
+struct Computed {
+    const DistanceMatrix &source;
+
+    inline double operator()(size_t i, size_t j) const { return source.compute(i, j); }
+};
+
+// the fixed reduction shared by all kernels, arc i lands in lane i % 8
+template <typename Lookup>
+double reduce(double *lane, const customer_t *p, int first, int n, const Lookup &m) {
+    for (int i = first; i + 1 < n; ++i)
+        lane[i % LANES] += m(p[i], p[i + 1]);
+    return ((lane[0] + lane[4]) + (lane[2] + lane[6])) + ((lane[1] + lane[5]) + (lane[3] + lane[7]));
+}
+
+template <typename Lookup>
+double scalarCost(const Lookup &m, const customer_t *p, int n) {
+    double lane[LANES] = { 0 };
+    return reduce(lane, p, 0, n, m);
+}
+
+#ifdef CVRP_X86_KERNELS
+
+// 8 node indices widened to 32 bits
+__attribute__((target("avx2")))
+inline __m256i load8(const customer_t *p) {
+    if (sizeof(customer_t) == 2) return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p));
+    return _mm256_loadu_si256((const __m256i*)p);
+}
+
+// entry offsets of the arcs p[i] -> p[i + 1], i < 8
+__attribute__((target("avx2")))
+inline __m256i offsets8(const customer_t *p, const Matrix &m) {
+    __m256i a = load8(p), b = load8(p + 1);
+    __m256i lo = _mm256_min_epu32(a, b), hi = _mm256_max_epu32(a, b);
+    __m256i row = m.square ? _mm256_mullo_epi32(hi, _mm256_set1_epi32((int)m.stride))
+        : _mm256_srli_epi32(_mm256_mullo_epi32(hi, _mm256_add_epi32(hi, _mm256_set1_epi32(1))), 1);
+    return _mm256_add_epi32(row, lo);
+}
+
+__attribute__((target("avx2")))
+double avx2Cost(const Matrix &m, const customer_t *p, int n) {
+    __m256d low = _mm256_setzero_pd(), high = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + LANES < n; i += LANES) {
+        __m256i offset = offsets8(p + i, m);
+#ifdef CVRP_FLOAT_DISTANCE
+        __m256 d = _mm256_i32gather_ps(m.data, offset, 4);
+        low = _mm256_add_pd(low, _mm256_cvtps_pd(_mm256_castps256_ps128(d)));
+        high = _mm256_add_pd(high, _mm256_cvtps_pd(_mm256_extractf128_ps(d, 1)));
+#else
+        low = _mm256_add_pd(low, _mm256_i32gather_pd(m.data, _mm256_castsi256_si128(offset), 8));
+        high = _mm256_add_pd(high, _mm256_i32gather_pd(m.data, _mm256_extracti128_si256(offset, 1), 8));
+#endif
+    }
+    double lane[LANES];
+    _mm256_storeu_pd(lane, low);
+    _mm256_storeu_pd(lane + 4, high);
+    return reduce(lane, p, i, n, m);
+}
+
+// exact euclidean arcs computed from gathered coordinates, 4 per half
+// no fused multiply-add, so they round like the scalar lookup
+__attribute__((target("avx2")))
+inline __m256d arcs4(const DistanceMatrix &m, __m128i a, __m128i b) {
+    __m256d dx = _mm256_sub_pd(_mm256_i32gather_pd(m.x(), a, 8), _mm256_i32gather_pd(m.x(), b, 8));
+    __m256d dy = _mm256_sub_pd(_mm256_i32gather_pd(m.y(), a, 8), _mm256_i32gather_pd(m.y(), b, 8));
+    __m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+#ifdef CVRP_FLOAT_DISTANCE
+    d = _mm256_cvtps_pd(_mm256_cvtpd_ps(d));
+#endif
+    return d;
+}
+
+__attribute__((target("avx2")))
+double avx2OnDemandCost(const Computed &m, const customer_t *p, int n) {
+    __m256d low = _mm256_setzero_pd(), high = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + LANES < n; i += LANES) {
+        __m256i a = load8(p + i), b = load8(p + i + 1);
+        low = _mm256_add_pd(low, arcs4(m.source, _mm256_castsi256_si128(a), _mm256_castsi256_si128(b)));
+        high = _mm256_add_pd(high, arcs4(m.source, _mm256_extracti128_si256(a, 1), _mm256_extracti128_si256(b, 1)));
+    }
+    double lane[LANES];
+    _mm256_storeu_pd(lane, low);
+    _mm256_storeu_pd(lane + 4, high);
+    return reduce(lane, p, i, n, m);
+}
+
+__attribute__((target("avx512f")))
+double avx512Cost(const Matrix &m, const customer_t *p, int n) {
+    __m512d sum = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + LANES < n; i += LANES) {
+        __m256i offset = offsets8(p + i, m);
+#ifdef CVRP_FLOAT_DISTANCE
+        sum = _mm512_add_pd(sum, _mm512_cvtps_pd(_mm256_i32gather_ps(m.data, offset, 4)));
+#else
+        sum = _mm512_add_pd(sum, _mm512_i32gather_pd(offset, m.data, 8));
+#endif
+    }
+    double lane[LANES];
+    _mm512_storeu_pd(lane, sum);
+    return reduce(lane, p, i, n, m);
+}
+
+#endif
+
+Fitness::Kernel detect() {
+    Fitness::Kernel widest = Fitness::supported(Fitness::AVX512)? Fitness::AVX512
+        : Fitness::supported(Fitness::AVX2)? Fitness::AVX2 : Fitness::SCALAR;
+
+    const char *cap = getenv("CVRP_SIMD");
+    if (cap) {
+        if (strcmp(cap, "scalar") == 0) widest = Fitness::SCALAR;
+        else if (strcmp(cap, "avx2") == 0 && widest > Fitness::AVX2) widest = Fitness::AVX2;
+    }
+    return widest;
+}
+
+}
+
+Fitness::Kernel Fitness::kernel() {
+    static const Kernel selected = detect();
+    return selected;
+}
+
+bool Fitness::supported(Kernel kernel) {
+#ifdef CVRP_X86_KERNELS
+    switch (kernel) {
+        case AVX2: return __builtin_cpu_supports("avx2");
+        case AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2");
+        default: return true;
+    }
+#else
+    return kernel == SCALAR;
+#endif
+}
+
+const char *Fitness::name(Kernel kernel) {
+    switch (kernel) {
+        case AVX2: return "avx2";
+        case AVX512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+double Fitness::cost(const DistanceMatrix &matrix, const Node *nodes, int n) {
+    return cost(kernel(), matrix, nodes, n);
+}
+
+double Fitness::cost(Kernel kernel, const DistanceMatrix &matrix, const Node *nodes, int n) {
+    const Matrix m(matrix);
+    const customer_t *p = reinterpret_cast<const customer_t*>(nodes);
+    // computed distances stay on avx2, an avx512 target may fuse the multiply-adds and round differently
+    if (matrix.layout() == DistanceMatrix::ON_DEMAND) {
+        const Computed c = { matrix };
+#ifdef CVRP_X86_KERNELS
+        if (matrix.metric() == DistanceMatrix::EXACT && kernel != SCALAR && supported(AVX2)) return avx2OnDemandCost(c, p, n);
+#endif
+        return scalarCost(c, p, n);
+    }
+#ifdef CVRP_X86_KERNELS
+    // the gathers take signed 32-bit offsets
+    if (matrix.bytes() / sizeof(distance_t) <= (size_t)INT_MAX && supported(kernel)) {
+        if (kernel == AVX512) return avx512Cost(m, p, n);
+        if (kernel == AVX2) return avx2Cost(m, p, n);
+    }
+#endif
+    return scalarCost(m, p, n);
+}
+
+void Fitness::costs(const DistanceMatrix &matrix, const Node *const *paths, const int *sizes, int count, double *costs) {
+    const Kernel k = kernel();
+    for (int i = 0; i < count; ++i)
+        costs[i] = cost(k, matrix, paths[i], sizes[i]);
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _FITNESS_CACHE_CC_
+#define _FITNESS_CACHE_CC_
+
+#include "fitness_cache.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+static inline uint64_t bitsOf(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline double valueOf(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+FitnessCache::FitnessCache(int bits): entries_(new Entry[(size_t)1 << bits]()), mask_(((uint64_t)1 << bits) - 1), lookups_(0), hits_(0) {}
+
+unsigned FitnessCache::find(uint64_t hash, double cost) const {
+    lookups_.fetch_add(1, memory_order_relaxed);
+    const Entry &entry = entries_[hash & mask_];
+    uint64_t c = entry.cost.load(memory_order_relaxed);
+    uint64_t f = entry.flags.load(memory_order_relaxed);
+    if ((entry.check.load(memory_order_relaxed) ^ c ^ f) != hash) return 0;
+    if (fabs(valueOf(c) - cost) > 1e-6 * (1 + fabs(cost))) return 0;
+    hits_.fetch_add(1, memory_order_relaxed);
+    return f;
+}
+
+void FitnessCache::insert(uint64_t hash, double cost, unsigned flags) {
+    Entry &entry = entries_[hash & mask_];
+    uint64_t c = bitsOf(cost), f = flags;
+    entry.check.store(hash ^ c ^ f, memory_order_relaxed);
+    entry.cost.store(c, memory_order_relaxed);
+    entry.flags.store(f, memory_order_relaxed);
+}
+
+#endif
@@ -9,11 +9,16 @@
 #ifndef _GENE_CC_
 #define _GENE_CC_
 
+#include "fitness.h"
 #include "gene.h"
 #include "node.h"
+#include "profiler.h"
+#include "split.h"
 #include "utility.h"
+#include "zobrist.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cstdio>
 #include <cmath>
 #include <vector>
@@ -21,276 +26,445 @@
 #define MIN(a, b) ((a) <= (b)? (a):(b))
 #define DEPOT Node(1)
 
-int Gene::capacity_ = 0;
-int Gene::dimension_ = 0;
-
 Gene &Gene::operator=(const Gene &gene) {
+    instance_ = gene.instance_;
     nodes_ = gene.nodes_;
+    cost_ = gene.cost_;
+    routes_ = gene.routes_;
+    hash_ = gene.hash_;
+    scored_ = gene.scored_;
+    indexed_ = false;
     return *this;
 }
 
-double Gene::cost() const {
-    double cost = 0;
-    
-    for (int i = 1; i < nodes_.size(); ++i) 
-        cost += nodes_[i](nodes_[i - 1]);
+void Gene::update() {
+    cost_ = Fitness::cost(instance_->distances(), nodes_.data(), nodes_.size());
+    routes_ = nodes_.empty()? 0 : count(nodes_.begin() + 1, nodes_.end(), DEPOT);
+    hash_ = scored_ = Zobrist::path(nodes_.data(), nodes_.size());
+    indexed_ = false;
+}
 
-    return cost;
+void Gene::evaluate(Gene *genes, int count) {
+    if (count == 0) return;
+    // scratch of the calling thread
+    static thread_local vector<const Node*> paths;
+    static thread_local vector<int> sizes, changed;
+    static thread_local vector<double> costs;
+    paths.clear();
+    sizes.clear();
+    changed.clear();
+    
+    for (int k = 0; k < count; ++k) {
+        if (genes[k].hash_ == genes[k].scored_) continue;
+        paths.push_back(genes[k].nodes_.data());
+        sizes.push_back(genes[k].nodes_.size());
+        changed.push_back(k);
+    }
+    costs.resize(changed.size());
+    Fitness::costs(genes[0].instance_->distances(), paths.data(), sizes.data(), changed.size(), costs.data());
+    for (int i = 0; i < changed.size(); ++i) {
+        Gene &gene = genes[changed[i]];
+        gene.cost_ = costs[i];
+        gene.scored_ = gene.hash_;
+    }
 }
 
 // assume the gene is already chopped
-void Gene::print() const {
-    printf("algorithm Genetic Algorithm with specialized crossover and mutation\n");
-    printf("cost %.3f\n1->", this->cost());  
+void Gene::print(FILE *out) const {
+    fprintf(out, "algorithm Genetic Algorithm with specialized crossover and mutation\n");
+    fprintf(out, "cost %.3f\n1->", this->cost());  
     for (int i = 1; i < nodes_.size() - 1; ++i) {
-        if (nodes_[i] == DEPOT) printf("1\n1->");
-        else printf("%d->", nodes_[i].tag());
+        if (nodes_[i] == DEPOT) fprintf(out, "1\n1->");
+        else fprintf(out, "%d->", nodes_[i].tag());
     }
-    printf("1\n");
-}
-
-// route based crossover
-Gene Gene::Rbx(const Gene &parent, const double &crossoverRate) {
-    if (generateRandom() < crossoverRate) {
-        vector<int> f_route{0}, m_route{0};
-        // store the depot locations 
-        for (int i = 1; i < nodes_.size(); ++i) {
-            if (nodes_[i] == DEPOT) 
-                f_route.push_back(i);
-        }
-        // number of routes in the current gene
-        int rF = f_route.size() - 1;
-        
-        for (int j = 1; j < parent.nodes_.size() - 1; ++j) {
-            if (parent.nodes_[j] == DEPOT) {
-                m_route.push_back(j);
-            }
-        }
-        // number of routes in the parent gene
-        int rM = m_route.size() - 1;
-        
-        int ith = generateRandom(0, MIN(rF, rM));
-        int f_start = f_route[ith], f_end = f_route[ith + 1];
-        int m_start = m_route[ith], m_end = m_route[ith + 1];
-        
-        // pieces from parent
-        vector<Node> fKid(parent.nodes_.begin() + m_start, parent.nodes_.begin() + m_end);
-        // pieces from this
-        vector<Node> mKid(nodes_.begin() + f_start, nodes_.begin() + f_end);
-        
-        for (int m = 0; m < nodes_.size(); ++m) {
-            if (!contain(fKid, nodes_[m]) || nodes_[m] == DEPOT)
-                fKid.push_back(nodes_[m]);
-        }
-        
-        for (int n = 0; n < parent.nodes_.size(); ++n) {
-            if (!contain(mKid, parent.nodes_[n]) || parent.nodes_[n] == DEPOT)
-                mKid.push_back(parent.nodes_[n]);
-        }
-        
-        Gene fg(fKid), mg(mKid);
-        fg.validate();
-        mg.validate();
-        
-        if (fg .cost() < mg.cost()) return fg;
-        else return mg;
-    } else return *this;
+    fprintf(out, "1\n");
 }
 
 // insert depots to the TSP like genes
+// the giant tour is split optimally, then expanded in place from the back
 void Gene::chop() {
-    int currentLoad = capacity_;
-    nodes_.insert(nodes_.begin(), DEPOT);
-
-    // marker for the starting node of a route
-    int pos(1);
-    
-    for (int i = 1; i < nodes_.size(); ++i) {
-        if (nodes_[i].demand() <= currentLoad) 
-            currentLoad -= nodes_[i].demand();
-        else {
-            // route ends at nodes_[i - 1]
-            // sort(first, last, comp): [first=pos, last=i)
-            // local optimization
-            vector<Node> tmp(nodes_.begin() + pos, nodes_.begin() + i);
-            sort(tmp.begin(), tmp.end(), [=](const Node &i, const Node &j){ return i(DEPOT) < j(DEPOT); });
-            for (int j = 0; j < tmp.size(); ++j) {
-                if (j & 1) nodes_[i - j/2 - 1] = tmp[j]; 
-                else nodes_[pos + j / 2] = tmp[j];
-            }
+    // route boundaries over the giant tour, reused by the thread
+    static thread_local vector<int> ends;
+    const int n = nodes_.size();
+    split(*instance_, nodes_.data(), n, ends);
+    const int routes = ends.size();
 
-            currentLoad = capacity_ - nodes_[i].demand();
-            nodes_.insert(nodes_.begin() + i, DEPOT);
-            pos = ++i;
-        }
+    nodes_.resize(n + routes + 1, DEPOT);
+    int pos = n + routes;
+    for (int r = routes - 1; r >= 0; --r) {
+        int start = (r > 0)? ends[r - 1] : 0;
+        nodes_[pos--] = DEPOT;
+        for (int k = ends[r] - 1; k >= start; --k) 
+            nodes_[pos--] = nodes_[k];
     }
-    nodes_.push_back(DEPOT);
+    nodes_[0] = DEPOT;
+    update();
 }
 
-vector<int> Gene::randomPos() {
-    vector<int> pos;
-
-    int p0(generateRandom(1, nodes_.size() - 1));
-    int p1(generateRandom(p0, nodes_.size() - 1));
-    pos.push_back(p0);
-    pos.push_back(p1);
-
-    return pos;
+// pick a random customer and one of its nearest neighbours
+// returns their positions in ascending order, needs the route index
+void Gene::randomPos(int &p0, int &p1) const {
+    do p0 = generateRandom(1, nodes_.size() - 1);
+    while (nodes_[p0] == DEPOT);
+    
+    p1 = position_[instance_->neighbours(nodes_[p0].index())[(int)generateRandom(0, instance_->neighbourCount())]];
+    if (p1 < p0) swap(p0, p1);
 }
 
 void Gene::sequentialMutate(const double &mutationRate, const double &temperature) {
     if (generateRandom() < mutationRate) {
-        Gene gene(*this);
-        vector<int> p(randomPos());
+        Profiler::Scope scope(Profiler::MUTATE);
+        ensureIndexed();
+        int p[2];
         
         for (int t = 0; t < 10; ++t) {
-            // if both of the selected nodes are depot
-            // do the random pick again
-            while (gene.nodes_[p[0]] == gene.nodes_[p[1]]) 
-                p = randomPos();
+            // moves only join a customer to one of its neighbours,
+            // routes change through emptied routes
+            randomPos(p[0], p[1]);
             
-            switch(t % 5) {
-                case 0:
-                {
+            // start from the t-th operator and fall through to the next
+            // one until a feasible move is found
+            for (int c = t % 5; c < 5; ++c) {
+                // the moves are listed in the order of Profiler::Operator
+                const Profiler::Operator op = (Profiler::Operator)(Profiler::INSERT + c);
+                Move move(Move::INSERTION, p[0], p[1]);
+                switch(c) {
                     // insertion 0->1
-                    gene.nodes_.insert(gene.nodes_.begin() + p[1], gene.nodes_[p[0]]);
-                    gene.nodes_.erase(gene.nodes_.begin() + p[0]);
-                    if (gene.validate()) {
-                        this->acceptGene(gene, temperature);
-                        break;
-                    }
-                }
-                
-                case 1:
-                {
+                    case 0: break;
                     // insertion 1->0
-                    gene = *this;
-                    Node node = gene.nodes_[p[1]];
-                    gene.nodes_.erase(gene.nodes_.begin() + p[1]);
-                    gene.nodes_.insert(gene.nodes_.begin() + p[0], node);
-                    if (gene.validate()) {
-                        this->acceptGene(gene, temperature);
-                        break;
-                    }
-                }
-                
-                case 2:
-                {
+                    case 1: move = Move(Move::INSERTION, p[1], p[0]); break;
                     // swap nodes
-                    gene = *this;
-                    swap(gene.nodes_[p[0]], gene.nodes_[p[1]]);
-                    if (gene.validate()) {
-                        this->acceptGene(gene, temperature);
-                        break;
-                    }
-                }
-                
-                
-                case 3:
-                {
+                    case 2: move.type = Move::SWAP; break;
                     // exchange two nodes
-                    gene = *this;
-                    swap(gene.nodes_[p[0]], gene.nodes_[p[1]]);
-                    swap(gene.nodes_[p[0] + 1], gene.nodes_[p[1] - 1]);
-                    if (gene.validate()) {
-                        this->acceptGene(gene, temperature);
+                    case 3: move.type = Move::EXCHANGE; break;
+                    // exchange outer pieces
+                    case 4:
+                    {
+                        int q = routeStart_[routeOf_[p[0]]];
+                        int len = routeStart_[routeOf_[p[1]] + 1] - p[1];
+                        move = Move(Move::SEGMENT_SWAP, p[0], p[1], generateRandom( 0, MIN( p[0] - q, len ) ) - 1);
                         break;
                     }
                 }
+                // an empty segment moves nothing, it is neither tried nor counted
+                if (move.type == Move::SEGMENT_SWAP && move.length <= 0) continue;
+                Profiler::count(op, Profiler::ATTEMPTS);
                 
-                
-                case 4:
-                {
-                    // exchange outer pieces
-                    gene = *this;
-                    int q;
-                    for (q = p[0]; q >= 0; --q) {
-                        if (gene.nodes_[q] == DEPOT) break;
-                    }
-                    int len = find(gene.nodes_.begin() + p[1], gene.nodes_.end(), DEPOT) - gene.nodes_.begin() - p[1];
-                    int length = generateRandom( 0, MIN( p[0] - q, len ) ) - 1;
-                    for (int j = 0; j < length; ++j) 
-                        swap(gene.nodes_[p[0] - j], gene.nodes_[p[1] + j]);
-                    if (gene.validate()) 
-                        this->acceptGene(gene, temperature);
+                if (feasible(move)) {
+                    double d = delta(move);
+                    bool accepted = accept(d, temperature);
+                    if (accepted) apply(move);
+                    Profiler::result(op, d, accepted);
+                    break;
                 }
             }
         }
+        
+        if (emptied_) compact();
     }
 }
 
-// if gene's cost is smaller and it's valid, swap it with the current gene
-void Gene::acceptGene(Gene &gene, const double &temperature) {
-    double diffE = this->cost() - gene.cost();
-    if (diffE > 0 || generateRandom() < BoltzmannProb(- diffE, temperature))
-        *this = gene;
+bool Gene::accept(const double &delta, const double &temperature) const {
+    return delta < 0 || generateRandom() < BoltzmannProb(delta, temperature);
 }
 
 // work for unchopped genes
 // randomly exchange nodes within every single route
 void Gene::optMutation(const double &mutationRate) {
     if (generateRandom() < mutationRate) {
-        // pos: record the starting position of a route
-        int pos(1);
+        Profiler::Scope scope(Profiler::OPT_MUTATE);
+        ensureIndexed();
         
-        for (int i = 2; i < nodes_.size(); ++i) {
-            if (nodes_[i] == DEPOT) {
-                int size(i - pos);
-                if (size > 1) {
-                    int p1, p2;
-                    do {
-                        p1 = generateRandom(0, size) + pos;
-                        p2 = generateRandom(p1, size + pos);
-                    } while (p1 == p2);
-                    
-                    vector<Node> org(nodes_.begin() + pos, nodes_.begin() + pos + size);
-                    swap(nodes_[p1], nodes_[p2]);
-                    vector<Node> curr(nodes_.begin() + pos, nodes_.begin() + pos + size);
-                    if (vectorCost(org) < vectorCost(curr))
-                        swap(nodes_[p1], nodes_[p2]);
-                }
+        for (int r = 0; r + 1 < routeStart_.size(); ++r) {
+            // pos: the starting position of the route
+            int pos(routeStart_[r] + 1);
+            int size(routeStart_[r + 1] - pos);
+            if (size > 1) {
+                int p1, p2;
+                do {
+                    p1 = generateRandom(0, size) + pos;
+                    p2 = generateRandom(p1, size + pos);
+                } while (p1 == p2);
                 
-                pos = i + 1;
+                // keep the swap unless it makes the route longer
+                Move move(Move::SWAP, p1, p2);
+                double d = delta(move);
+                if (d <= 0) 
+                    apply(move);
+                Profiler::count(Profiler::OPT_SWAP, Profiler::ATTEMPTS);
+                Profiler::result(Profiler::OPT_SWAP, d, d <= 0);
             }
         }
+    }
+}
+
+// cost change of rearranging positions, where source(k) is the position
+// whose node ends up at k and only the listed arcs (k, k + 1) may change
+template <typename Source>
+double Gene::arcDelta(const int *arcs, int n, Source source) const {
+    double delta = 0;
+    for (int i = 0; i < n; ++i) {
+        int k = arcs[i];
+        if (find(arcs, arcs + i, k) != arcs + i) continue;
+        delta += distance(source(k), source(k + 1)) - distance(k, k + 1);
+    }
+    return delta;
+}
+
+double Gene::delta(const Move &move) const {
+    const int a = move.from, b = move.to;
+    
+    switch (move.type) {
+        case Move::INSERTION:
+            if (b == a || b == a + 1) return 0;
+            return distance(a - 1, a + 1) - distance(a - 1, a) - distance(a, a + 1)
+                 + distance(b - 1, a) + distance(a, b) - distance(b - 1, b);
+        
+        case Move::SWAP:
+            if (b == a + 1) 
+                return distance(a - 1, b) + distance(a, b + 1) - distance(a - 1, a) - distance(b, b + 1);
+            return distance(a - 1, b) + distance(b, a + 1) + distance(b - 1, a) + distance(a, b + 1)
+                 - distance(a - 1, a) - distance(a, a + 1) - distance(b - 1, b) - distance(b, b + 1);
+        
+        case Move::EXCHANGE:
+        {
+            if (b == a + 1) return 0;
+            const int arcs[] = { a - 1, a, a + 1, b - 2, b - 1, b };
+            return arcDelta(arcs, 6, [=](int k) {
+                if (k == a) return b;
+                if (k == b) return a;
+                if (k == a + 1) return b - 1;
+                if (k == b - 1) return a + 1;
+                return k;
+            });
+        }
         
+        case Move::SEGMENT_SWAP:
+        {
+            const int len = move.length;
+            if (len <= 0) return 0;
+            // segment internals are reversed copies, only the borders change
+            const int arcs[] = { a - len, a, b - 1, b + len - 1 };
+            return arcDelta(arcs, 4, [=](int k) {
+                if (k > a - len && k <= a) return b + (a - k);
+                if (k >= b && k < b + len) return a - (k - b);
+                return k;
+            });
+        }
     }
+    return 0;
 }
 
-// calculate the cost for one route (no depot representation)
-double vectorCost(const vector<Node> &nodes) {
-    double cost = nodes[0](DEPOT);
-    for (int i = 1; i < nodes.size(); ++i)
-        cost += nodes[i](nodes[i - 1]);
-    // plus cost for one route
-    return cost + nodes.back()(DEPOT);
+bool Gene::feasible(const Move &move) const {
+    const int a = move.from, b = move.to;
+    const int capacity = instance_->capacity();
+    
+    switch (move.type) {
+        case Move::INSERTION:
+        {
+            if (b == a || b == a + 1) return true;
+            int from = routeOf_[a], to = routeOf_[b - 1];
+            return from == to || load_[to] + demand(nodes_[a]) <= capacity;
+        }
+        
+        case Move::SWAP:
+        {
+            int ra = routeOf_[a], rb = routeOf_[b];
+            int diff = demand(nodes_[b]) - demand(nodes_[a]);
+            return ra == rb || (load_[ra] + diff <= capacity && load_[rb] - diff <= capacity);
+        }
+        
+        case Move::EXCHANGE:
+        {
+            if (b == a + 1) return true;
+            // the inner pair must not move a depot
+            if (b > a + 2 && (nodes_[a + 1] == DEPOT || nodes_[b - 1] == DEPOT)) return false;
+            int ra = routeOf_[a], rb = routeOf_[b];
+            int diff = demand(nodes_[b]) - demand(nodes_[a]);
+            if (b > a + 2) diff += demand(nodes_[b - 1]) - demand(nodes_[a + 1]);
+            return ra == rb || (load_[ra] + diff <= capacity && load_[rb] - diff <= capacity);
+        }
+        
+        case Move::SEGMENT_SWAP:
+        {
+            const int len = move.length;
+            if (len <= 0) return true;
+            int ra = routeOf_[a], rb = routeOf_[b];
+            // both segments have to stay inside their routes
+            if (a - len < routeStart_[ra] || b + len > routeStart_[rb + 1]) return false;
+            if (ra == rb) return true;
+            int diff = (prefixLoad_[b + len - 1] - prefixLoad_[b - 1]) - (prefixLoad_[a] - prefixLoad_[a - len]);
+            return load_[ra] + diff <= capacity && load_[rb] - diff <= capacity;
+        }
+    }
+    return false;
 }
 
-// only work for chopped genes
-bool Gene::validate() {
-    int currentLoad = capacity_;
-    vector<Node>::iterator it = nodes_.begin() + 1;
-    while (it != nodes_.end()) {
-        if (it->demand() <= currentLoad) {
-            if (*it == DEPOT) {
-                if (currentLoad < capacity_) {
-                    currentLoad = capacity_;
-                    it++;
-                } else nodes_.erase(it - 1);
+void Gene::apply(const Move &move) {
+    const int a = move.from, b = move.to;
+    cost_ += delta(move);
+    
+    switch (move.type) {
+        case Move::INSERTION:
+        {
+            if (b == a || b == a + 1) return;
+            int from = routeOf_[a], to = routeOf_[b - 1];
+            // inserting into an emptied route opens it again
+            if (to != from && load_[to] == 0) --emptied_;
+            if (a < b) {
+                rotate(nodes_.begin() + a, nodes_.begin() + a + 1, nodes_.begin() + b);
+                indexSpan(a, b - 1);
             } else {
-                currentLoad -= it->demand();
-                it++;
+                rotate(nodes_.begin() + b, nodes_.begin() + a, nodes_.begin() + a + 1);
+                indexSpan(b, a);
             }
-        } else return false;
+            indexRoute(from);
+            if (to != from) indexRoute(to);
+            // an emptied route stays until the next compaction
+            if (load_[from] == 0) ++emptied_;
+            checkIndex();
+            return;
+        }
+        
+        case Move::SWAP:
+            swap(nodes_[a], nodes_[b]);
+            break;
+        
+        case Move::EXCHANGE:
+            swap(nodes_[a], nodes_[b]);
+            swap(nodes_[a + 1], nodes_[b - 1]);
+            break;
+        
+        case Move::SEGMENT_SWAP:
+            for (int j = 0; j < move.length; ++j) 
+                swap(nodes_[a - j], nodes_[b + j]);
+            break;
+    }
+    
+    // customers only moved between positions, the route bounds hold
+    indexRoute(routeOf_[a]);
+    if (routeOf_[b] != routeOf_[a]) indexRoute(routeOf_[b]);
+    checkIndex();
+}
+
+void Gene::indexRoutes() {
+    const int capacity = instance_->capacity();
+    position_.resize(instance_->dimension());
+    routeOf_.resize(nodes_.size());
+    prefixLoad_.resize(nodes_.size());
+    load_.clear();
+    routeCost_.clear();
+    routeHash_.clear();
+    routeStart_.clear();
+    
+    for (int i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i] == DEPOT) {
+            routeStart_.push_back(i);
+            load_.push_back(0);
+            routeCost_.push_back(0);
+            routeHash_.push_back(0);
+        }
+        routeOf_[i] = load_.size() - 1;
+        load_.back() += demand(nodes_[i]);
+        prefixLoad_[i] = load_.back();
+        if (i + 1 < nodes_.size()) {
+            routeCost_.back() += distance(i, i + 1);
+            routeHash_.back() += Zobrist::arc(nodes_[i].index(), nodes_[i + 1].index());
+        }
+        position_[nodes_[i].index()] = i;
+    }
+    // the final depot only closes the last route
+    load_.pop_back();
+    routeCost_.pop_back();
+    routeHash_.pop_back();
+    routes_ = load_.size();
+    
+    overloaded_ = emptied_ = 0;
+    for (int r = 0; r < routes_; ++r) {
+        if (load_[r] > capacity) ++overloaded_;
+        if (load_[r] == 0) ++emptied_;
+    }
+    indexed_ = true;
+}
+
+void Gene::indexRoute(int r) {
+    const int capacity = instance_->capacity();
+    if (load_[r] > capacity) --overloaded_;
+    
+    int load = 0;
+    double cost = 0;
+    uint64_t hash = 0;
+    for (int i = routeStart_[r]; i < routeStart_[r + 1]; ++i) {
+        load += demand(nodes_[i]);
+        cost += distance(i, i + 1);
+        hash += Zobrist::arc(nodes_[i].index(), nodes_[i + 1].index());
+        prefixLoad_[i] = load;
+        position_[nodes_[i].index()] = i;
     }
+    load_[r] = load;
+    routeCost_[r] = cost;
+    hash_ += hash - routeHash_[r];
+    routeHash_[r] = hash;
+    
+    if (load > capacity) ++overloaded_;
+}
 
-    return true;
+void Gene::indexSpan(int lo, int hi) {
+    // the depots in the span keep their count, so route numbers hold
+    // routes crossing the span ends are reindexed by the caller
+    int r = routeOf_[lo - 1], load = prefixLoad_[lo - 1];
+    for (int i = lo; i <= hi; ++i) {
+        if (nodes_[i] == DEPOT) {
+            routeStart_[++r] = i;
+            load = 0;
+        }
+        load += demand(nodes_[i]);
+        routeOf_[i] = r;
+        prefixLoad_[i] = load;
+        position_[nodes_[i].index()] = i;
+    }
 }
 
-int Gene::setDimensionAndCapacity(const vector<int> &dimensionAndCapacity) {
-    dimension_ = dimensionAndCapacity[0];
-    capacity_ = dimensionAndCapacity[1];
-    return dimension_;
+void Gene::compact() {
+    // depot to depot arcs cost nothing, so the cost holds
+    int kept = 1;
+    for (int i = 1; i < nodes_.size(); ++i) 
+        if (nodes_[i] != DEPOT || nodes_[kept - 1] != DEPOT) 
+            nodes_[kept++] = nodes_[i];
+    
+    routes_ -= nodes_.size() - kept;
+    nodes_.resize(kept, DEPOT);
+    emptied_ = 0;
+    if (indexed_) indexRoutes();
+}
+
+void Gene::checkIndex() const {
+#ifdef CVRP_DEBUG
+    Gene fresh(*this);
+    fresh.update();
+    fresh.indexRoutes();
+    assert(fresh.routeStart_ == routeStart_ && fresh.load_ == load_);
+    assert(fresh.overloaded_ == overloaded_ && fresh.emptied_ == emptied_);
+    assert(equal(fresh.prefixLoad_.begin(), fresh.prefixLoad_.end(), prefixLoad_.begin()));
+    assert(equal(fresh.routeOf_.begin(), fresh.routeOf_.end(), routeOf_.begin()));
+    for (int r = 0; r < routes_; ++r) 
+        assert(fabs(fresh.routeCost_[r] - routeCost_[r]) < 1e-6 * (1 + routeCost_[r]));
+    assert(fabs(fresh.cost_ - cost_) < 1e-6 * (1 + cost_));
+    assert(fresh.hash_ == hash_ && fresh.routeHash_ == routeHash_);
+#endif
+}
+
+// calculate the cost for one route (no depot representation)
+double vectorCost(const ProblemInstance &instance, const vector<Node> &nodes) {
+    double cost = Fitness::cost(instance.distances(), nodes.data(), nodes.size());
+    // plus cost for one route
+    return cost + instance.distance(nodes[0].index(), 0) + instance.distance(nodes.back().index(), 0);
+}
+
+// only work for chopped genes
+bool Gene::validate() {
+    ensureIndexed();
+    return overloaded_ == 0;
 }
 
 #endif
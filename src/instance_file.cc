@@ -0,0 +1,294 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _INSTANCE_FILE_CC_
+#define _INSTANCE_FILE_CC_
+
+#include "instance_file.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// read-only mapping of a whole file
+struct MappedFile {
+    const char *data;
+    size_t size;
+
+    MappedFile(const char *path): data(nullptr), size(0) {
+        int fd = open(path, O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            fprintf(stderr, "cannot open %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+        size = info.st_size;
+        if (size > 0) {
+            void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                fprintf(stderr, "cannot map %s\n", path);
+                exit(EXIT_FAILURE);
+            }
+            madvise(p, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(p);
+        }
+        close(fd);
+    }
+    ~MappedFile() { if (data) munmap(const_cast<char*>(data), size); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+};
+
+// token pointing into the mapping, never copied
+struct Token {
+    const char *begin;
+    size_t length;
+
+    inline bool is(const char *word) const { return length == strlen(word) && memcmp(begin, word, length) == 0; }
+};
+
+// powers of ten that are exact in double precision
+const double POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+// forward-only cursor over the mapped text
+class Scanner {
+  private:
+    const char *path_, *begin_, *p_, *end_;
+
+    static inline bool blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+    static inline bool digit(char c) { return c >= '0' && c <= '9'; }
+    static inline bool wordChar(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || digit(c) || c == '_'; }
+
+  public:
+    Scanner(const char *path, const char *data, size_t size): path_(path), begin_(data), p_(data), end_(data + size) {}
+
+    inline bool done() const { return p_ >= end_; }
+
+    inline void skipBlanks() { while (p_ < end_ && blank(*p_)) ++p_; }
+    inline void skipSpace() { while (p_ < end_ && (blank(*p_) || *p_ == '\n')) ++p_; }
+    inline void skipLine() {
+        const char *q = static_cast<const char*>(memchr(p_, '\n', end_ - p_));
+        p_ = q ? q + 1 : end_;
+    }
+
+    // keyword followed by an optional colon
+    Token keyword() {
+        skipSpace();
+        Token token = { p_, 0 };
+        while (p_ < end_ && wordChar(*p_)) ++p_;
+        token.length = p_ - token.begin;
+        skipBlanks();
+        if (p_ < end_ && *p_ == ':') ++p_;
+        skipBlanks();
+        return token;
+    }
+
+    // rest of the line without surrounding blanks
+    Token value() {
+        skipBlanks();
+        Token token = { p_, 0 };
+        while (p_ < end_ && *p_ != '\n') ++p_;
+        const char *last = p_;
+        while (last > token.begin && blank(last[-1])) --last;
+        token.length = last - token.begin;
+        return token;
+    }
+
+    // decimal number with optional fraction and exponent
+    double number() {
+        skipSpace();
+        const char *q = p_;
+        bool negative = false;
+        if (q < end_ && (*q == '-' || *q == '+')) negative = (*q++ == '-');
+
+        uint64_t mantissa = 0;
+        int exponent = 0, digits = 0;
+        for (; q < end_ && digit(*q); ++q, ++digits) {
+            if (mantissa < 100000000000000000ULL) mantissa = mantissa * 10 + (*q - '0');
+            else ++exponent;
+        }
+        if (q < end_ && *q == '.') {
+            for (++q; q < end_ && digit(*q); ++q, ++digits) {
+                if (mantissa < 100000000000000000ULL) {
+                    mantissa = mantissa * 10 + (*q - '0');
+                    --exponent;
+                }
+            }
+        }
+        if (digits == 0) fail("number expected");
+
+        if (q < end_ && (*q == 'e' || *q == 'E')) {
+            ++q;
+            bool negativeExponent = false;
+            if (q < end_ && (*q == '-' || *q == '+')) negativeExponent = (*q++ == '-');
+            int e = 0;
+            for (; q < end_ && digit(*q); ++q)
+                if (e < 10000) e = e * 10 + (*q - '0');
+            exponent += negativeExponent ? -e : e;
+        }
+        p_ = q;
+
+        // exact for mantissas below 2^53 scaled by a representable power
+        double value = (double)mantissa;
+        if (exponent != 0) {
+            if (mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22)
+                value = (exponent < 0)? value / POW10[-exponent] : value * POW10[exponent];
+            else
+                value *= pow(10.0, exponent);
+        }
+        return negative ? -value : value;
+    }
+
+    long integer() {
+        double value = number();
+        if (value != floor(value)) fail("integer expected");
+        return (long)value;
+    }
+
+    // 1-based node id checked against the dimension, returned 0-based
+    int node(int dimension) {
+        long id = integer();
+        if (id < 1 || id > dimension) fail("node id out of range");
+        return id - 1;
+    }
+
+    void fail(const char *message) const {
+        int line = 1;
+        for (const char *q = begin_; q < p_ && q < end_; ++q)
+            if (*q == '\n') ++line;
+        fprintf(stderr, "%s:%d: %s\n", path_, line, message);
+        exit(EXIT_FAILURE);
+    }
+};
+
+DistanceMatrix::Metric metricOf(const Token &type, const Scanner &scanner) {
+    if (type.is("EUC_2D")) return DistanceMatrix::EUC_2D;
+    if (type.is("CEIL_2D")) return DistanceMatrix::CEIL_2D;
+    if (type.is("ATT")) return DistanceMatrix::ATT;
+    if (type.is("MAN_2D")) return DistanceMatrix::MAN_2D;
+    if (type.is("MAX_2D")) return DistanceMatrix::MAX_2D;
+    if (type.is("EXACT_2D")) return DistanceMatrix::EXACT;
+    scanner.fail("unsupported EDGE_WEIGHT_TYPE");
+    return DistanceMatrix::EXACT;
+}
+
+// explicit weights in any TSPLIB format, stored into the lower triangle
+// a symmetric problem is assumed, FULL_MATRIX keeps its lower half
+void readWeights(Scanner &scanner, const Token &format, InstanceFile &instance) {
+    const int n = instance.dimension;
+    instance.lower.assign((size_t)n * (n + 1) / 2, 0);
+
+    // column formats of one triangle list the same order as row formats of the other
+    bool full = format.is("FULL_MATRIX"), lowerRows, diagonal;
+    if (full) lowerRows = false, diagonal = true;
+    else if (format.is("LOWER_DIAG_ROW") || format.is("UPPER_DIAG_COL")) lowerRows = true, diagonal = true;
+    else if (format.is("LOWER_ROW") || format.is("UPPER_COL")) lowerRows = true, diagonal = false;
+    else if (format.is("UPPER_DIAG_ROW") || format.is("LOWER_DIAG_COL")) lowerRows = false, diagonal = true;
+    else if (format.is("UPPER_ROW") || format.is("LOWER_COL")) lowerRows = false, diagonal = false;
+    else {
+        scanner.fail("unsupported EDGE_WEIGHT_FORMAT");
+        return;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        // row i lists the columns [from, to)
+        int from = (full || lowerRows)? 0 : (diagonal ? i : i + 1);
+        int to = (full || !lowerRows)? n : (diagonal ? i + 1 : i);
+        for (int j = from; j < to; ++j) {
+            double w = scanner.number();
+            if (full && j > i) continue;
+            int hi = (i > j)? i : j, lo = i ^ j ^ hi;
+            instance.lower[(size_t)hi * (hi + 1) / 2 + lo] = w;
+        }
+    }
+}
+
+}
+
+void readInstance(const char *path, InstanceFile &instance) {
+    MappedFile file(path);
+    Scanner scanner(path, file.data, file.size);
+    Token format = { "FUNCTION", 8 };
+    bool hasDemands = false;
+
+    while (!scanner.done()) {
+        Token key = scanner.keyword();
+        if (key.length == 0) {
+            if (scanner.done()) break;
+            scanner.fail("keyword expected");
+        }
+
+        if (key.is("NAME")) {
+            Token name = scanner.value();
+            instance.name.assign(name.begin, name.length);
+        } else if (key.is("DIMENSION")) {
+            instance.dimension = scanner.integer();
+            // the neighbour lists and the moves pair a customer with another one
+            if (instance.dimension < 3) scanner.fail("DIMENSION must be at least 3, a depot and two customers");
+            instance.x.assign(instance.dimension, 0);
+            instance.y.assign(instance.dimension, 0);
+            instance.demands.assign(instance.dimension, 0);
+        } else if (key.is("CAPACITY")) {
+            instance.capacity = scanner.integer();
+        } else if (key.is("EDGE_WEIGHT_TYPE")) {
+            Token type = scanner.value();
+            instance.explicitWeights = type.is("EXPLICIT");
+            if (!instance.explicitWeights) instance.metric = metricOf(type, scanner);
+        } else if (key.is("EDGE_WEIGHT_FORMAT")) {
+            format = scanner.value();
+        } else if (key.is("NODE_COORD_SECTION") || key.is("DISPLAY_DATA_SECTION")) {
+            if (instance.dimension == 0) scanner.fail("DIMENSION must precede the sections");
+            for (int k = 0; k < instance.dimension; ++k) {
+                int i = scanner.node(instance.dimension);
+                instance.x[i] = scanner.number();
+                instance.y[i] = scanner.number();
+                // ignore a third coordinate
+                scanner.skipLine();
+            }
+            instance.hasCoordinates = true;
+        } else if (key.is("DEMAND_SECTION")) {
+            if (instance.dimension == 0) scanner.fail("DIMENSION must precede the sections");
+            for (int k = 0; k < instance.dimension; ++k) {
+                int i = scanner.node(instance.dimension);
+                instance.demands[i] = scanner.integer();
+            }
+            hasDemands = true;
+        } else if (key.is("DEPOT_SECTION")) {
+            // the solver keeps the depot at node 1
+            for (long id = scanner.integer(); id != -1; id = scanner.integer())
+                if (id != 1) scanner.fail("only a single depot at node 1 is supported");
+        } else if (key.is("EDGE_WEIGHT_SECTION")) {
+            if (instance.dimension == 0) scanner.fail("DIMENSION must precede the sections");
+            readWeights(scanner, format, instance);
+        } else if (key.is("EOF")) {
+            break;
+        } else {
+            // COMMENT, TYPE, DISTANCE, VEHICLES and other unused keywords
+            scanner.skipLine();
+        }
+    }
+
+    if (instance.dimension == 0 || instance.capacity <= 0 || !hasDemands) scanner.fail("DIMENSION, CAPACITY and DEMAND_SECTION are required");
+    if (instance.explicitWeights ? instance.lower.empty() : !instance.hasCoordinates) scanner.fail("missing NODE_COORD_SECTION or EDGE_WEIGHT_SECTION");
+}
+
+#endif
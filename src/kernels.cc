@@ -0,0 +1,58 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _KERNELS_CC_
+#define _KERNELS_CC_
+
+#include "kernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+const int Kernels::SMALL_DIMENSION;
+const int Kernels::NARROW_DIMENSION;
+
+namespace {
+
+Kernels::Shape cap() {
+    const char *cap = getenv("CVRP_KERNEL");
+    if (cap) {
+        if (strcmp(cap, "wide") == 0) return Kernels::WIDE;
+        if (strcmp(cap, "narrow") == 0) return Kernels::NARROW;
+        if (strcmp(cap, "small") == 0) return Kernels::SMALL;
+    }
+    return Kernels::SMALL_INTEGER;
+}
+
+}
+
+Kernels::Shape Kernels::shape(const ProblemInstance &instance) {
+    static const Shape widest = cap();
+
+    const int dimension = instance.dimension();
+    Shape shape = WIDE;
+    if (dimension <= NARROW_DIMENSION) shape = NARROW;
+    if (dimension <= SMALL_DIMENSION && instance.distances().layout() == DistanceMatrix::SQUARE) {
+        shape = SMALL;
+        if (instance.integerDistances()) shape = SMALL_INTEGER;
+    }
+    return (shape < widest)? shape : widest;
+}
+
+const char *Kernels::name(Shape shape) {
+    switch (shape) {
+        case NARROW: return "narrow";
+        case SMALL: return "small";
+        case SMALL_INTEGER: return "small_integer";
+        default: return "wide";
+    }
+}
+
+#endif
@@ -0,0 +1,606 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _LOCAL_SEARCH_CC_
+#define _LOCAL_SEARCH_CC_
+
+#include "local_search.h"
+#include "gene.h"
+#include "kernels.h"
+#include "node.h"
+#include "random.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#define DEPOT Node(1)
+
+using namespace std;
+
+namespace {
+
+// smallest cost change accepted as an improvement
+const double EPSILON = 1e-9;
+
+// polar sector around the depot covered by a route, in degrees
+struct Sector {
+    double start, end;
+    bool empty;
+
+    static inline double positive(double a) {
+        a = fmod(a, 360);
+        return (a < 0)? a + 360 : a;
+    }
+
+    inline void reset() { empty = true; }
+    // grow towards the closer side
+    void extend(double a) {
+        if (empty) {
+            start = end = a;
+            empty = false;
+        } else if (positive(a - start) > positive(end - start)) {
+            if (positive(a - end) <= positive(start - a)) end = a;
+            else start = a;
+        }
+    }
+    inline bool overlaps(const Sector &other) const {
+        return positive(other.start - start) <= positive(end - start) || positive(start - other.start) <= positive(other.end - other.start);
+    }
+};
+
+template <typename Cost>
+struct Route {
+    // depot ids at both ends
+    int start, end;
+    int size, load;
+    Cost cost;
+    Sector sector;
+    // clock of the last change
+    long stamp;
+};
+
+// three cheapest insertion points of a customer into one route
+template <typename Cost>
+struct Insertion {
+    Cost cost[3];
+    int after[3];
+
+    inline void reset() {
+        for (int k = 0; k < 3; ++k) {
+            cost[k] = numeric_limits<Cost>::max();
+            after[k] = -1;
+        }
+    }
+    inline void add(Cost c, int w) {
+        if (c >= cost[2]) return;
+        int k = 2;
+        for (; k > 0 && c < cost[k - 1]; --k) {
+            cost[k] = cost[k - 1];
+            after[k] = after[k - 1];
+        }
+        cost[k] = c;
+        after[k] = w;
+    }
+};
+
+// candidate move, u and v are node ids
+template <typename Cost>
+struct Candidate {
+    // OR_OPT: move the segment of length nodes from u after v, reversed or not
+    // SWAP: exchange u and v
+    // TWO_OPT: reverse the path after u up to v, same route
+    // TWO_OPT_STAR: exchange the tails after u and after v
+    // TWO_OPT_STAR_REVERSED: connect u to v and their tails to each other
+    enum Type { NONE, OR_OPT, SWAP, TWO_OPT, TWO_OPT_STAR, TWO_OPT_STAR_REVERSED };
+    Type type;
+    int u, v, length;
+    bool reversed;
+    Cost delta;
+};
+
+// doubly linked routes over node ids, customers keep their instance index
+// and route r is closed by the depot ids dimension + 2r and dimension + 2r + 1
+// the last route is always empty so that a move may open a new one
+// shaped by Kernels: Index stores the ids, Lookup reads the distances in its
+// Cost type, a MaxDimension fixes the arrays, routes never outnumber the
+// customers so the ids stay below 3 * MaxDimension
+template <typename Index, typename Lookup, int MaxDimension>
+struct Search {
+    typedef typename Lookup::Cost Cost;
+    typedef ::Route<Cost> Route;
+    typedef Candidate<Cost> Move;
+    static const size_t IDS = 3 * MaxDimension;
+
+    const ProblemInstance *instance;
+    Lookup lookup;
+    int dimension, capacity;
+    Buffer<Index, IDS> next, prev, route, position;
+    Buffer<int, IDS> prefixLoad;
+    vector<Route> routes;
+    // customers whose routes did not change since their last fruitless scan
+    Buffer<unsigned char, MaxDimension> dontLook;
+    vector<int> order, segment, other;
+    // SWAP* preprocessing by customer
+    Buffer<Insertion<Cost>, MaxDimension> insertion;
+    Buffer<Cost, MaxDimension> removal;
+    long evaluations, budget;
+    // counts route changes, SWAP* skips pairs unchanged since its last pass
+    long clock, swapStarClock;
+    bool bestImprovement;
+    Move best;
+
+    inline bool depot(int id) const { return id >= dimension; }
+    inline bool opening(int id) const { return id >= dimension && ((id - dimension) & 1) == 0; }
+    inline Cost d(int a, int b) const { return lookup(depot(a)? 0 : a, depot(b)? 0 : b); }
+    inline int q(int id) const { return depot(id)? 0 : instance->demand(id); }
+    inline void link(int a, int b) { next[a] = b; prev[b] = a; }
+    inline bool exhausted() const { return budget > 0 && evaluations >= budget; }
+
+    void load(const ProblemInstance*, const NodeList&);
+    void store(NodeList&) const;
+    void addRoute();
+    void updateRoute(int);
+
+    // record a candidate, true once a first-improvement search should apply it
+    bool consider(typename Move::Type, int u, int v, Cost delta, int length = 0, bool reversed = false);
+    void apply(const Move&);
+
+    void orOpt(int u, int v, bool&);
+    void exchange(int u, int v, bool&);
+    void twoOpt(int u, int v, bool&);
+    void twoOptStar(int u, int v, bool&);
+    // scan the neighbourhoods of a customer, true if a move was applied
+    bool improve(int u);
+
+    void prepareSwapStar(int from, int into);
+    Cost cheapestInsertion(int u, int v, int &after) const;
+    bool swapStar(int, int);
+    bool swapStar();
+};
+
+// one search per shape and thread, on the heap since the fixed arrays are large
+template <class S>
+S &scratch() {
+    static thread_local unique_ptr<S> s;
+    if (!s) s.reset(new S());
+    return *s;
+}
+
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::load(const ProblemInstance *inst, const NodeList &nodes) {
+    instance = inst;
+    lookup = Lookup(*inst);
+    dimension = inst->dimension();
+    capacity = inst->capacity();
+    evaluations = 0;
+    clock = 0;
+    swapStarClock = -1;
+
+    routes.clear();
+    next.resize(dimension);
+    prev.resize(dimension);
+    route.resize(dimension);
+    position.resize(dimension);
+    prefixLoad.resize(dimension);
+    dontLook.assign(dimension, 0);
+    insertion.resize(dimension);
+    removal.resize(dimension);
+
+    // empty routes are dropped on the way in
+    addRoute();
+    int last = routes.back().start;
+    for (int i = 1; i < nodes.size(); ++i) {
+        if (nodes[i] != DEPOT) {
+            link(last, nodes[i].index());
+            last = nodes[i].index();
+        } else if (last != routes.back().start) {
+            link(last, routes.back().end);
+            addRoute();
+            last = routes.back().start;
+        }
+    }
+    for (int r = 0; r < (int)routes.size(); ++r)
+        updateRoute(r);
+}
+
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::store(NodeList &nodes) const {
+    nodes.clear();
+    nodes.push_back(DEPOT);
+    for (int r = 0; r < (int)routes.size(); ++r) {
+        if (routes[r].size == 0) continue;
+        for (int id = next[routes[r].start]; !depot(id); id = next[id])
+            nodes.push_back(Node(id + 1));
+        nodes.push_back(DEPOT);
+    }
+}
+
+// append an empty route
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::addRoute() {
+    int r = routes.size();
+    int size = dimension + 2 * (r + 1);
+    next.resize(size);
+    prev.resize(size);
+    route.resize(size);
+    position.resize(size);
+    prefixLoad.resize(size);
+
+    Route empty;
+    empty.start = dimension + 2 * r;
+    empty.end = empty.start + 1;
+    routes.push_back(empty);
+    link(empty.start, empty.end);
+    updateRoute(r);
+}
+
+// walk a route after a move, its end depot may have changed
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::updateRoute(int r) {
+    Route &R = routes[r];
+    int id = R.start, p = 0, load = 0;
+    Cost cost = 0;
+    R.sector.reset();
+    R.stamp = ++clock;
+    route[id] = r;
+    position[id] = 0;
+    prefixLoad[id] = 0;
+    while (true) {
+        cost += d(id, next[id]);
+        id = next[id];
+        route[id] = r;
+        position[id] = ++p;
+        if (depot(id)) break;
+        load += q(id);
+        dontLook[id] = 0;
+        R.sector.extend(instance->angle(id));
+        prefixLoad[id] = load;
+    }
+    prefixLoad[id] = load;
+    R.end = id;
+    R.size = p - 1;
+    R.load = load;
+    R.cost = cost;
+}
+
+template <typename Index, typename Lookup, int MaxDimension>
+bool Search<Index, Lookup, MaxDimension>::consider(typename Move::Type type, int u, int v, Cost delta, int length, bool reversed) {
+    if (delta >= best.delta) return false;
+    best.type = type;
+    best.u = u;
+    best.v = v;
+    best.delta = delta;
+    best.length = length;
+    best.reversed = reversed;
+    return !bestImprovement;
+}
+
+// relocate the segments of 1 to 3 customers starting at u after v
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::orOpt(int u, int v, bool &stop) {
+    const int pu = prev[u];
+    if (v == pu) return;
+    const bool sameRoute = route[u] == route[v];
+    int e = u, load = q(u);
+    for (int length = 1; length <= 3 && !stop; ++length) {
+        if (length > 1) {
+            e = next[e];
+            if (depot(e) || e == v) return;
+            load += q(e);
+        }
+        if (!sameRoute && routes[route[v]].load + load > capacity) return;
+
+        const int ne = next[e];
+        const int y = (v == ne)? next[ne] : next[v];
+        Cost removed = d(pu, ne) - d(pu, u) - d(e, ne);
+        stop = consider(Move::OR_OPT, u, v, removed + d(v, u) + d(e, y) - d(v, y), length, false);
+        if (length > 1 && !stop)
+            stop = consider(Move::OR_OPT, u, v, removed + d(v, e) + d(u, y) - d(v, y), length, true);
+    }
+}
+
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::exchange(int u, int v, bool &stop) {
+    if (v == next[u] || v == prev[u]) return;
+    const int ru = route[u], rv = route[v];
+    if (ru != rv && (routes[ru].load - q(u) + q(v) > capacity || routes[rv].load - q(v) + q(u) > capacity)) return;
+    const int pu = prev[u], x = next[u], pv = prev[v], y = next[v];
+    stop = consider(Move::SWAP, u, v, d(pu, v) + d(v, x) - d(pu, u) - d(u, x) + d(pv, u) + d(u, y) - d(pv, v) - d(v, y));
+}
+
+// reverse the path between two customers of one route
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::twoOpt(int u, int v, bool &stop) {
+    if (position[u] > position[v]) swap(u, v);
+    const int x = next[u], y = next[v];
+    if (x == v) return;
+    stop = consider(Move::TWO_OPT, u, v, d(u, v) + d(x, y) - d(u, x) - d(v, y));
+}
+
+// v may be the opening depot of its route
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::twoOptStar(int u, int v, bool &stop) {
+    const Route &A = routes[route[u]], &B = routes[route[v]];
+    const int x = next[u], y = next[v];
+    if (prefixLoad[u] + B.load - prefixLoad[v] <= capacity && prefixLoad[v] + A.load - prefixLoad[u] <= capacity)
+        stop = consider(Move::TWO_OPT_STAR, u, v, d(u, y) + d(v, x) - d(u, x) - d(v, y));
+    if (!stop && !depot(v) && prefixLoad[u] + prefixLoad[v] <= capacity && A.load - prefixLoad[u] + B.load - prefixLoad[v] <= capacity)
+        stop = consider(Move::TWO_OPT_STAR_REVERSED, u, v, d(u, v) + d(x, y) - d(u, x) - d(v, y));
+}
+
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::apply(const Move &c) {
+    const int u = c.u, v = c.v, ru = route[u], rv = route[v];
+    segment.clear();
+
+    switch (c.type) {
+    case Move::OR_OPT: {
+        for (int id = u, k = 0; k < c.length; id = next[id], ++k)
+            segment.push_back(id);
+        link(prev[u], next[segment.back()]);
+        const int y = next[v];
+        int cur = v;
+        if (c.reversed) {
+            for (int k = c.length - 1; k >= 0; --k) {
+                link(cur, segment[k]);
+                cur = segment[k];
+            }
+        } else {
+            for (int k = 0; k < c.length; ++k) {
+                link(cur, segment[k]);
+                cur = segment[k];
+            }
+        }
+        link(cur, y);
+        break;
+    }
+    case Move::SWAP: {
+        const int pu = prev[u], x = next[u], pv = prev[v], y = next[v];
+        link(pu, v);
+        link(v, x);
+        link(pv, u);
+        link(u, y);
+        break;
+    }
+    case Move::TWO_OPT: {
+        const int first = next[u], y = next[v];
+        for (int id = first; ; id = next[id]) {
+            segment.push_back(id);
+            if (id == v) break;
+        }
+        int cur = u;
+        for (int k = segment.size() - 1; k >= 0; --k) {
+            link(cur, segment[k]);
+            cur = segment[k];
+        }
+        link(cur, y);
+        break;
+    }
+    case Move::TWO_OPT_STAR: {
+        const int x = next[u], y = next[v];
+        link(u, y);
+        link(v, x);
+        break;
+    }
+    case Move::TWO_OPT_STAR_REVERSED: {
+        const int endU = routes[ru].end, startV = routes[rv].start, y = next[v];
+        // head of v's route and tail of u's route, both in order
+        for (int id = next[startV]; ; id = next[id]) {
+            segment.push_back(id);
+            if (id == v) break;
+        }
+        other.clear();
+        for (int id = next[u]; !depot(id); id = next[id])
+            other.push_back(id);
+        int cur = u;
+        for (int k = segment.size() - 1; k >= 0; --k) {
+            link(cur, segment[k]);
+            cur = segment[k];
+        }
+        link(cur, endU);
+        cur = startV;
+        for (int k = other.size() - 1; k >= 0; --k) {
+            link(cur, other[k]);
+            cur = other[k];
+        }
+        link(cur, y);
+        break;
+    }
+    default:
+        return;
+    }
+
+    updateRoute(ru);
+    if (rv != ru) updateRoute(rv);
+    // keep an empty route at the back
+    if (routes.back().size > 0) addRoute();
+}
+
+template <typename Index, typename Lookup, int MaxDimension>
+bool Search<Index, Lookup, MaxDimension>::improve(int u) {
+    const customer_t *neighbours = instance->neighbours(u);
+    const int k = instance->neighbourCount();
+    best.type = Move::NONE;
+    // truncates to 0 for integer costs, where any negative delta improves
+    best.delta = -EPSILON;
+    bool stop = false;
+
+    for (int j = 0; j < k && !stop && !exhausted(); ++j) {
+        const int v = neighbours[j];
+        if (v == u) continue;
+        ++evaluations;
+
+        orOpt(u, v, stop);
+        if (!stop) exchange(u, v, stop);
+        if (!stop) {
+            if (route[u] == route[v]) twoOpt(u, v, stop);
+            else twoOptStar(u, v, stop);
+        }
+        // v opens its route, also try u right after the depot
+        if (!stop && opening(prev[v])) {
+            orOpt(u, prev[v], stop);
+            if (!stop && route[u] != route[v]) twoOptStar(u, prev[v], stop);
+        }
+    }
+    // open a new route
+    if (!stop && !exhausted() && routes[route[u]].size > 1) orOpt(u, routes.back().start, stop);
+
+    if (best.type == Move::NONE) return false;
+    apply(best);
+    return true;
+}
+
+// removal gains of the customers of one route and their cheapest insertions into another
+template <typename Index, typename Lookup, int MaxDimension>
+void Search<Index, Lookup, MaxDimension>::prepareSwapStar(int from, int into) {
+    for (int u = next[routes[from].start]; !depot(u); u = next[u]) {
+        removal[u] = d(prev[u], next[u]) - d(prev[u], u) - d(u, next[u]);
+        Insertion<Cost> &ins = insertion[u];
+        ins.reset();
+        for (int w = routes[into].start; w != routes[into].end; w = next[w])
+            ins.add(d(w, u) + d(u, next[w]) - d(w, next[w]), w);
+    }
+}
+
+// cheapest insertion of u into the route of v once v is removed
+template <typename Index, typename Lookup, int MaxDimension>
+typename Search<Index, Lookup, MaxDimension>::Cost Search<Index, Lookup, MaxDimension>::cheapestInsertion(int u, int v, int &after) const {
+    const int pv = prev[v], y = next[v];
+    Cost cost = d(pv, u) + d(u, y) - d(pv, y);
+    after = pv;
+    const Insertion<Cost> &ins = insertion[u];
+    for (int k = 0; k < 3 && ins.after[k] >= 0; ++k) {
+        int w = ins.after[k];
+        if (w == v || next[w] == v) continue;
+        if (ins.cost[k] < cost) {
+            cost = ins.cost[k];
+            after = w;
+        }
+        break;
+    }
+    return cost;
+}
+
+// exchange a customer of each route, both reinserted at their cheapest positions
+template <typename Index, typename Lookup, int MaxDimension>
+bool Search<Index, Lookup, MaxDimension>::swapStar(int r1, int r2) {
+    prepareSwapStar(r1, r2);
+    prepareSwapStar(r2, r1);
+    const Route &A = routes[r1], &B = routes[r2];
+    evaluations += (long)A.size * B.size;
+
+    Cost bestDelta = -EPSILON;
+    int bu = -1, bv = -1, au = -1, av = -1;
+    for (int u = next[A.start]; !depot(u); u = next[u]) {
+        for (int v = next[B.start]; !depot(v); v = next[v]) {
+            if (A.load - q(u) + q(v) > capacity || B.load - q(v) + q(u) > capacity) continue;
+            int wu, wv;
+            Cost delta = removal[u] + removal[v];
+            delta += cheapestInsertion(u, v, wu);
+            delta += cheapestInsertion(v, u, wv);
+            if (delta < bestDelta) {
+                bestDelta = delta;
+                bu = u, bv = v, au = wu, av = wv;
+            }
+        }
+    }
+    if (bu < 0) return false;
+
+    link(prev[bu], next[bu]);
+    link(prev[bv], next[bv]);
+    link(bu, next[au]);
+    link(au, bu);
+    link(bv, next[av]);
+    link(av, bv);
+    updateRoute(r1);
+    updateRoute(r2);
+    return true;
+}
+
+template <typename Index, typename Lookup, int MaxDimension>
+bool Search<Index, Lookup, MaxDimension>::swapStar() {
+    bool improved = false;
+    const long since = swapStarClock;
+    swapStarClock = clock;
+    for (int r1 = 0; r1 < (int)routes.size(); ++r1) {
+        for (int r2 = r1 + 1; r2 < (int)routes.size(); ++r2) {
+            if (exhausted()) return improved;
+            if (routes[r1].size == 0 || routes[r2].size == 0 || max(routes[r1].stamp, routes[r2].stamp) <= since) continue;
+            if (!routes[r1].sector.overlaps(routes[r2].sector)) continue;
+            if (swapStar(r1, r2)) improved = true;
+        }
+    }
+    return improved;
+}
+
+}
+
+double LocalSearch::operator()(Gene &gene) const {
+    return (*this)(gene, Kernels::shape(*gene.instance_));
+}
+
+double LocalSearch::operator()(Gene &gene, Kernels::Shape shape) const {
+    const double before = gene.cost();
+    // the search would rescore the gene and leave it as it is
+    if (cache_ && (cache_->find(gene.hash(), gene.cost()) & FitnessCache::LOCAL_OPTIMUM)) {
+        gene.update();
+        return gene.cost() - before;
+    }
+
+    bool optimum;
+    switch (min(shape, Kernels::shape(*gene.instance_))) {
+        case Kernels::SMALL_INTEGER: optimum = descend< Search<uint16_t, IntegerLookup, Kernels::SMALL_DIMENSION> >(gene); break;
+        case Kernels::SMALL: optimum = descend< Search<uint16_t, SquareLookup, Kernels::SMALL_DIMENSION> >(gene); break;
+        case Kernels::NARROW: optimum = descend< Search<uint16_t, InstanceLookup, 0> >(gene); break;
+        default: optimum = descend< Search<uint32_t, InstanceLookup, 0> >(gene);
+    }
+
+    gene.update();
+    // a search that ran out of budget may have stopped short of the optimum
+    if (cache_ && optimum) cache_->insert(gene.hash(), gene.cost(), FitnessCache::LOCAL_OPTIMUM);
+#ifdef CVRP_DEBUG
+    assert(gene.validate());
+    assert(gene.cost() <= before + 1e-6);
+#endif
+    return gene.cost() - before;
+}
+
+template <class S>
+bool LocalSearch::descend(Gene &gene) const {
+    S &s = scratch<S>();
+    s.budget = budget_;
+    s.bestImprovement = bestImprovement_;
+    s.load(gene.instance_, gene.nodes_);
+
+    // customers in an order drawn from the hash, the descent itself is deterministic
+    s.order.clear();
+    for (int i = 1; i < s.dimension; ++i)
+        s.order.push_back(i);
+    Xoshiro256 engine(gene.hash());
+    shuffle(s.order.begin(), s.order.end(), engine);
+
+    for (bool improved = true; improved && !s.exhausted(); ) {
+        improved = false;
+        for (int k = 0; k < (int)s.order.size() && !s.exhausted(); ++k) {
+            int u = s.order[k];
+            if (s.dontLook[u]) continue;
+            if (s.improve(u)) improved = true;
+            else s.dontLook[u] = 1;
+        }
+        if (!s.exhausted() && s.swapStar()) improved = true;
+    }
+
+    s.store(gene.nodes_);
+    return !s.exhausted();
+}
+
+#endif
@@ -6,27 +6,189 @@
  *     \   /    \   /  * ** *   *
  *      ---      ---   wngfra    *
  * ******************************/
+#include "checkpoint.h"
 #include "cvrp.h"
 #include "gene.h"
+#include "local_search.h"
 #include "node.h"
+#include "portfolio.h"
+#include "problem_instance.h"
+#include "profiler.h"
+#include "random.h"
+#include "selection.h"
+#include "stopping.h"
+#include "telemetry.h"
 
 #include <chrono>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
 
 using namespace std;
 using namespace std::chrono;
 
 
+// usage: CVRP instance.vrp [more.vrp ...] [seed] [--option value ...]
+// several instances are solved concurrently as one batch
+//   --islands N     evolve N islands in parallel (1: single population)
+//   --migration N   generations between island migrations
+//   --migrants N    elite genes sent per migration
+//   --crossover OP  rbx (route based, default), ox or erx on the giant tour
+//   --selection S   roulette (default) or tournament parent selection
+//   --tournament K  genes per tournament (default 2)
+//   --local-search N  move evaluations per child, 0 (default) descends to a
+//                     local optimum, negative turns the local search off
+//   --best-improvement 1  apply the best move per customer, not the first
+//   --sample N      record evolution data every N generations
+//   --improvements 1  record only generations improving the best cost
+//   --binary FILE   also write the evolution data in binary columnar form
+//   --generations N length of the run and of the annealing schedule
+//   --time S        stop after S seconds, the schedule follows the budget
+//   --stagnation N  stop after N generations without improvement
+//   --target C      stop once the best cost reaches C
+//   --incumbent FILE  rewrite FILE with every new best solution
+//   --checkpoint FILE  snapshot the run to FILE while solving
+//   --checkpoint-every N  generations between snapshots (default 1000)
+//   --resume FILE   continue from a snapshot, generations count on from it
+//   --warm-start FILE  seed the population with a solution in the output format
+//   --table-limit N  compute distances on demand above N nodes instead of
+//                    storing the table (default 10000)
+//   --profile FILE  write operator counts and times to FILE (CSV if it ends
+//                   in .csv, JSON otherwise) at the end and on SIGUSR1,
+//                   needs a build with -DCVRP_PROFILE=ON
+//   --portfolio N   solve N independent runs with sampled parameters on the
+//                   threads, queued runs start as threads free up, a thread
+//                   of a cancelled run starts a fresh one, keeps the best
+//                   and --time bounds the whole portfolio
+//   --portfolio-margin M  cancel a run costing more than 1 + M times the best
+//                         other run at the same time (default 0.02)
+//   --portfolio-warmup S  seconds before a run can be cancelled (default a
+//                         fifth of --time, 1 without it)
 int main(int argc, char** argv){
 
     
     high_resolution_clock::time_point t1 = high_resolution_clock::now();
 
-    vector<int> dimAndCap = Node::initialize(argv[1]);
-    int dimension = Gene::setDimensionAndCapacity(dimAndCap);
-    CVRP::setDimension(dimension);
-    CVRP cvrp(120, 1000000, 0.75, 0.15, 5000);
-    cvrp.solve();
+    vector<char*> files;
+    map<string, string> options;
+    char *seedArg = NULL;
+    for (int a = 1; a < argc; ++a) {
+        if (strncmp(argv[a], "--", 2) == 0 && a + 1 < argc) {
+            options[argv[a] + 2] = argv[a + 1];
+            ++a;
+        }
+        else if (strspn(argv[a], "0123456789") == strlen(argv[a])) seedArg = argv[a];
+        else files.push_back(argv[a]);
+    }
+    auto option = [&](const char *name, double value) { return options.count(name)? atof(options[name].c_str()) : value; };
+
+    // optional master seed, a run is reproducible for a given seed and thread count
+    unsigned long long seed = seedArg? strtoull(seedArg, NULL, 10) : random_device()();
+    Random::seed(seed);
+    printf("seed %llu\n", seed);
+
+    int generations = option("generations", 1000000);
+    int tableLimit = option("table-limit", DistanceMatrix::TABLE_LIMIT);
+    if (options.count("profile")) Profiler::open(options["profile"]);
+
+    if (files.size() == 1) {
+        int portfolio = option("portfolio", 0);
+        if (portfolio > 0 && (options.count("checkpoint") || options.count("resume"))) {
+            fprintf(stderr, "--portfolio does not take --checkpoint or --resume\n");
+            return 1;
+        }
+
+        shared_ptr<const ProblemInstance> instance = ProblemInstance::load(files[0], 20, tableLimit);
+        CVRP cvrp(instance, 120, generations, 0.75, 0.15, 5000);
+        cvrp.setIslands(option("islands", 1), option("migration", 100), option("migrants", 2));
+        
+        Crossover::Type crossover = Crossover::RBX;
+        if (options.count("crossover") && !Crossover::parse(options["crossover"], crossover)) {
+            fprintf(stderr, "unknown crossover %s\n", options["crossover"].c_str());
+            return 1;
+        }
+        cvrp.setCrossover(crossover);
+        
+        Selection::Type selection = Selection::ROULETTE;
+        if (options.count("selection") && !Selection::parse(options["selection"], selection)) {
+            fprintf(stderr, "unknown selection %s\n", options["selection"].c_str());
+            return 1;
+        }
+        cvrp.setSelection(Selection(selection, option("tournament", 2)));
+        
+        int localSearch = option("local-search", 0);
+        if (localSearch >= 0) cvrp.setLocalSearch(LocalSearch(localSearch, option("best-improvement", 0)));
+        
+        StoppingCriteria stopping;
+        stopping.timeBudget = option("time", 0);
+        stopping.stagnation = option("stagnation", 0);
+        stopping.targetCost = option("target", 0);
+        cvrp.setStoppingCriteria(stopping);
+        
+        if (options.count("checkpoint")) 
+            cvrp.setCheckpoint(make_shared<Checkpoint>(options["checkpoint"], option("checkpoint-every", 1000)));
+        if (options.count("resume")) {
+            shared_ptr<Snapshot> snapshot = make_shared<Snapshot>();
+            Checkpoint::load(options["resume"], *instance, *snapshot);
+            printf("resuming generation %d seed %llu\n", snapshot->parts[0].generation, (unsigned long long)snapshot->seed);
+            cvrp.resume(snapshot);
+        } else if (options.count("warm-start")) {
+            vector<Node> tour;
+            readSolution(options["warm-start"].c_str(), *instance, tour);
+            cvrp.setWarmStart(tour);
+        }
+        
+        // anytime output: replace the file atomically on every improvement
+        string incumbentFile = options["incumbent"];
+        Incumbent::Callback writeIncumbent;
+        if (!incumbentFile.empty()) {
+            writeIncumbent = [=](const Gene &gene, double elapsed) {
+                string temp = incumbentFile + ".tmp";
+                FILE *out = fopen(temp.c_str(), "w");
+                if (!out) return;
+                gene.print(out);
+                fprintf(out, "time %.3f\n", elapsed);
+                fclose(out);
+                rename(temp.c_str(), incumbentFile.c_str());
+            };
+        }
+
+        if (portfolio > 0) {
+            // the configured solver is the template of every run, no telemetry
+            Portfolio runner(cvrp, Portfolio::sample(cvrp, portfolio, seed), option("portfolio-margin", 0.02), 
+                option("portfolio-warmup", (stopping.timeBudget > 0)? 0.2 * stopping.timeBudget : 1));
+            if (writeIncumbent) runner.incumbent()->setCallback(writeIncumbent);
+            Gene best = runner.solve();
+            for (int k = 0; k < runner.runs().size(); ++k) {
+                const Portfolio::Run &run = runner.runs()[k];
+                printf("run %d seed %llu genes %d crossover %.3f mutation %.3f temperature %.1f cost %.2f generations %d time %.3f%s\n", 
+                    k, (unsigned long long)run.seed, run.numOfGenes, run.crossoverRate, run.mutationRate, run.temperature, 
+                    run.cost, run.generations, run.elapsed, run.cancelled? " cancelled" : run.curve.empty()? " not started" : "");
+            }
+            best.print();
+        } else {
+            if (writeIncumbent) cvrp.setIncumbentCallback(writeIncumbent);
+            cvrp.setTelemetry(make_shared<Telemetry>("evolution_data.csv", 
+                option("improvements", 0)? Telemetry::IMPROVEMENT : Telemetry::EVERY, 
+                option("sample", 1), options["binary"]));
+            cvrp.solve();
+        }
+    } else {
+        vector< shared_ptr<const ProblemInstance> > instances;
+        for (int k = 0; k < files.size(); ++k) 
+            instances.push_back(ProblemInstance::load(files[k], 20, tableLimit));
+        
+        vector<Gene> best = CVRP::solveBatch(instances, 120, generations, 0.75, 0.15, 5000);
+        for (int k = 0; k < best.size(); ++k) {
+            printf("instance %s\n", files[k]);
+            best[k].print();
+        }
+    }
+    
+    Profiler::write();
    
     high_resolution_clock::time_point t2 = high_resolution_clock::now();
     duration<double> time_span = duration_cast<duration<double>>(t2 - t1);    
@@ -0,0 +1,33 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _POPULATION_CC_
+#define _POPULATION_CC_
+
+#include "population.h"
+
+#include <new>
+
+using namespace std;
+
+const size_t Population::ALIGNMENT;
+
+void Population::allocate(int slots, int dimension) {
+    // customers, one depot per route and the closing depot,
+    // plus the donated route a crossover child holds before validation
+    const size_t perLine = ALIGNMENT / sizeof(Node);
+    stride_ = (2 * dimension + 2 + perLine - 1) / perLine * perLine;
+    slots_ = slots;
+
+    void *p = nullptr;
+    size_t bytes = (size_t)slots_ * stride_ * sizeof(Node);
+    if (posix_memalign(&p, ALIGNMENT, bytes ? bytes : 1) != 0) throw bad_alloc();
+    arena_.reset(static_cast<Node*>(p));
+}
+
+#endif
@@ -0,0 +1,198 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _PORTFOLIO_CC_
+#define _PORTFOLIO_CC_
+
+#include "portfolio.h"
+#include "random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// seconds between two looks of the monitor
+const double INTERVAL = 0.05;
+// fresh runs allowed per given run, to replace cancelled ones
+const int RESTARTS = 3;
+
+// what the monitor knows of a run
+struct Slot {
+    enum State { QUEUED, RUNNING, DONE };
+    atomic<int> state;
+    // written before the state turns RUNNING
+    steady_clock::time_point start;
+    shared_ptr<Incumbent> incumbent;
+    // owned by the monitor until it is joined
+    vector< pair<double, double> > curve;
+    bool cancelled;
+
+    Slot(): state(QUEUED), incumbent(make_shared<Incumbent>()), cancelled(false) {}
+};
+
+double since(steady_clock::time_point start) {
+    return duration_cast< duration<double> >(steady_clock::now() - start).count();
+}
+
+// best cost of a curve after t seconds, infinite before its first sample
+double costAt(const vector< pair<double, double> > &curve, double t) {
+    vector< pair<double, double> >::const_iterator it = upper_bound(curve.begin(), curve.end(), make_pair(t, numeric_limits<double>::infinity()));
+    return (it == curve.begin())? numeric_limits<double>::infinity() : (it - 1)->second;
+}
+
+// one look at every run: sample the running ones and stop the dominated ones
+void watch(vector<Slot> &slots, double margin, double warmup) {
+    for (size_t k = 0; k < slots.size(); ++k) {
+        Slot &slot = slots[k];
+        if (slot.state.load(memory_order_acquire) != Slot::RUNNING) continue;
+
+        const double t = since(slot.start), cost = slot.incumbent->cost();
+        const bool solved = cost < numeric_limits<double>::infinity();
+        if (solved) slot.curve.push_back(make_pair(t, cost));
+        // Incumbent::start() clears a stop that came before it, so repeat it
+        if (slot.cancelled) {
+            slot.incumbent->stop();
+            continue;
+        }
+        // a run still building its first population is not judged
+        if (t < warmup || !solved) continue;
+
+        double reference = numeric_limits<double>::infinity();
+        for (size_t j = 0; j < slots.size(); ++j)
+            if (j != k) reference = min(reference, costAt(slots[j].curve, t));
+        if (cost > (1 + margin) * reference) {
+            slot.cancelled = true;
+            slot.incumbent->stop();
+        }
+    }
+}
+
+}
+
+Portfolio::Portfolio(const CVRP &prototype, const vector<Run> &runs, double margin, double warmup): prototype_(prototype), runs_(runs), margin_(max(margin, 0.0)), warmup_(max(warmup, 0.0)), incumbent_(make_shared<Incumbent>()) {}
+
+Portfolio::Run Portfolio::draw(const CVRP &prototype, uint64_t seed) {
+    Run run;
+    run.seed = seed;
+
+    // half to twice the population, a tenth to ten times the temperature
+    Xoshiro256 engine(seed);
+    run.numOfGenes = max((int)(prototype.numOfGenes_ * pow(2.0, (int)engine.below(3) - 1.0)), 4);
+    run.crossoverRate = 0.5 + 0.45 * engine.real();
+    run.mutationRate = 0.05 + 0.25 * engine.real();
+    run.temperature = prototype.temperature_ * pow(10.0, 2 * engine.real() - 1);
+    return run;
+}
+
+vector<Portfolio::Run> Portfolio::sample(const CVRP &prototype, int n, uint64_t seed) {
+    vector<Run> runs(max(n, 1));
+    runs[0].seed = seed;
+    runs[0].numOfGenes = prototype.numOfGenes_;
+    runs[0].crossoverRate = prototype.crossoverRate_;
+    runs[0].mutationRate = prototype.mutationRate_;
+    runs[0].temperature = prototype.temperature_;
+    for (int k = 1; k < runs.size(); ++k) 
+        runs[k] = draw(prototype, seed + k);
+    return runs;
+}
+
+Gene Portfolio::solve() {
+    const int n = runs_.size(), limit = (1 + RESTARTS) * n;
+    const double budget = prototype_.stopping_.timeBudget;
+    // fresh runs continue the seeds of the given ones
+    const uint64_t seed = runs_[0].seed;
+    runs_.resize(limit);
+    vector<Slot> slots(limit);
+    incumbent_->start();
+
+    atomic<bool> finished(false);
+    thread monitor([&]() {
+        while (!finished.load(memory_order_acquire)) {
+            watch(slots, margin_, warmup_);
+            this_thread::sleep_for(duration<double>(INTERVAL));
+        }
+    });
+
+    // a serial solve with the prototype's operators and criteria, within
+    // what is left of the time budget, true if the monitor cancelled it
+    auto solveRun = [&](int k) {
+        Run &run = runs_[k];
+        Slot &slot = slots[k];
+
+        CVRP cvrp(prototype_.instance_, run.numOfGenes, prototype_.numOfGenerations_, run.crossoverRate, run.mutationRate, run.temperature);
+        cvrp.parallel_ = false;
+        cvrp.crossover_ = prototype_.crossover_;
+        cvrp.selection_ = prototype_.selection_;
+        cvrp.localSearch_ = prototype_.localSearch_;
+        cvrp.memetic_ = prototype_.memetic_;
+        cvrp.stopping_ = prototype_.stopping_;
+        cvrp.warmStart_ = prototype_.warmStart_;
+        cvrp.incumbent_ = slot.incumbent;
+        shared_ptr<Incumbent> best = incumbent_;
+        slot.incumbent->setCallback([best](const Gene &gene, double) { best->offer(gene); });
+
+        run.cost = numeric_limits<double>::infinity();
+        if (budget > 0) {
+            cvrp.stopping_.timeBudget = budget - incumbent_->elapsed();
+            // queued past the deadline, never started
+            if (cvrp.stopping_.timeBudget <= 0) return false;
+        }
+
+        // the run's own stream on this thread
+        Random::engine().seed(run.seed);
+        slot.start = steady_clock::now();
+        slot.state.store(Slot::RUNNING, memory_order_release);
+        cvrp.run();
+
+        run.elapsed = since(slot.start);
+        run.cost = slot.incumbent->cost();
+        run.generations = cvrp.generationsRun();
+        slot.state.store(Slot::DONE, memory_order_release);
+        // only the monitor stops a serial run through its incumbent
+        return slot.incumbent->stopped() && (budget == 0 || incumbent_->elapsed() < budget);
+    };
+
+    // every thread takes the next queued run, a thread whose run was
+    // cancelled with time left starts a fresh run once the queue is empty,
+    // so no core idles while the budget lasts
+    atomic<int> queued(0), fresh(n);
+    #pragma omp parallel
+    {
+        bool cancelled = false;
+        for (;;) {
+            int k = queued.fetch_add(1);
+            if (k >= n) {
+                if (!cancelled || (k = fresh.fetch_add(1)) >= limit) break;
+                runs_[k] = draw(prototype_, seed + k);
+            }
+            cancelled = solveRun(k);
+        }
+    }
+
+    finished.store(true, memory_order_release);
+    monitor.join();
+
+    runs_.resize(min(fresh.load(), limit));
+    for (int k = 0; k < runs_.size(); ++k) {
+        Run &run = runs_[k];
+        run.cancelled = slots[k].cancelled;
+        run.curve.swap(slots[k].curve);
+        if (run.generations > 0) run.curve.push_back(make_pair(run.elapsed, run.cost));
+    }
+    return incumbent_->get();
+}
+
+#endif
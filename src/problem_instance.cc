@@ -0,0 +1,179 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _PROBLEM_INSTANCE_CC_
+#define _PROBLEM_INSTANCE_CC_
+
+#include "instance_file.h"
+#include "kernels.h"
+#include "problem_instance.h"
+#include "utility.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#define MIN(a, b) ((a) < (b)? (a):(b))
+
+namespace {
+
+typedef vector< pair<double, customer_t> > Nearest;
+
+// bounded max-heap of the k nearest candidates seen so far, ties go to the lower index
+inline void offer(Nearest &nearest, int k, double key, customer_t j) {
+    if (k <= 0) return;
+    if ((int)nearest.size() < k) {
+        nearest.push_back(make_pair(key, j));
+        push_heap(nearest.begin(), nearest.end());
+    } else if (make_pair(key, j) < nearest.front()) {
+        pop_heap(nearest.begin(), nearest.end());
+        nearest.back() = make_pair(key, j);
+        push_heap(nearest.begin(), nearest.end());
+    }
+}
+
+// uniform grid of the customers, about two per cell, for nearest
+// neighbour queries without scanning every customer
+struct Grid {
+    double minX, minY, width;
+    int side;
+    // customers of cell c are items[start[c]] up to items[start[c + 1]]
+    vector<int> start, items;
+
+    Grid(const vector<double> &x, const vector<double> &y) {
+        const int n = x.size();
+        double maxX = x[0], maxY = y[0];
+        minX = x[0];
+        minY = y[0];
+        for (int i = 1; i < n; ++i) {
+            minX = min(minX, x[i]);
+            minY = min(minY, y[i]);
+            maxX = max(maxX, x[i]);
+            maxY = max(maxY, y[i]);
+        }
+        side = max(1, (int)sqrt((n - 1) / 2.0));
+        width = max(max(maxX - minX, maxY - minY) / side, 1e-9);
+
+        // counting sort of the customers by cell
+        start.assign(side * side + 1, 0);
+        for (int j = 1; j < n; ++j) 
+            ++start[cell(x[j], y[j]) + 1];
+        for (int c = 0; c < side * side; ++c) 
+            start[c + 1] += start[c];
+        items.resize(n - 1);
+        vector<int> fill(start.begin(), start.end() - 1);
+        for (int j = 1; j < n; ++j) 
+            items[fill[cell(x[j], y[j])]++] = j;
+    }
+
+    inline int column(double v, double lo) const { return max(0, min(side - 1, (int)((v - lo) / width))); }
+    inline int cell(double px, double py) const { return column(py, minY) * side + column(px, minX); }
+
+    // k nearest customers of node i by squared euclidean length, the same
+    // set and order as a full scan
+    void nearest(const vector<double> &x, const vector<double> &y, int i, int k, Nearest &out) const {
+        out.clear();
+        const int cx = column(x[i], minX), cy = column(y[i], minY);
+        auto visit = [&](int gx, int gy) {
+            const int c = gy * side + gx;
+            for (int t = start[c]; t < start[c + 1]; ++t) {
+                int j = items[t];
+                if (j == i) continue;
+                double dx = x[i] - x[j], dy = y[i] - y[j];
+                offer(out, k, dx * dx + dy * dy, (customer_t)j);
+            }
+        };
+        for (int r = 0; r <= side; ++r) {
+            // the cells of ring r around the cell of i
+            for (int gy = max(cy - r, 0); gy <= min(cy + r, side - 1); ++gy) {
+                if (gy == cy - r || gy == cy + r) {
+                    for (int gx = max(cx - r, 0); gx <= min(cx + r, side - 1); ++gx) 
+                        visit(gx, gy);
+                } else {
+                    if (cx - r >= 0) visit(cx - r, gy);
+                    if (cx + r < side) visit(cx + r, gy);
+                }
+            }
+            // every customer beyond ring r is at least r cells away
+            double reach = r * width * (1 - 1e-9);
+            if ((int)out.size() == k && out.front().first < reach * reach) break;
+        }
+        sort_heap(out.begin(), out.end());
+    }
+};
+
+}
+
+ProblemInstance::ProblemInstance(const char *fileName, int neighbourCount, int tableLimit) {
+    InstanceFile file;
+    readInstance(fileName, file);
+    
+    dimension_ = file.dimension;
+    capacity_ = file.capacity;
+    demands_ = file.demands;
+
+    // explicit instances without display coordinates get no angular order
+    for (int i = 0; i < dimension_; ++i) 
+        angles_.push_back(file.hasCoordinates ? arctan(file.x[i] - file.x[0], file.y[i] - file.y[0]) : 0);
+
+    // large instances keep only the coordinates
+    if (file.explicitWeights) distance_.build(dimension_, file.lower);
+    else distance_.build(file.x, file.y, file.metric, (dimension_ > tableLimit)? DistanceMatrix::ON_DEMAND : DistanceMatrix::AUTO);
+
+    // integer copy for the integer kernels, dropped at the first fractional distance
+    if (dimension_ <= Kernels::SMALL_DIMENSION && distance_.layout() != DistanceMatrix::ON_DEMAND) {
+        integers_.resize((size_t)dimension_ * dimension_);
+        for (int i = 0; i < dimension_ && !integers_.empty(); ++i) {
+            for (int j = 0; j < dimension_; ++j) {
+                double w = distance_(i, j);
+                if (w != floor(w) || w < 0 || w > INT32_MAX) {
+                    integers_.clear();
+                    break;
+                }
+                integers_[(size_t)i * dimension_ + j] = (int32_t)w;
+            }
+        }
+        integers_.shrink_to_fit();
+    }
+
+    // granular neighbourhood: k nearest customers of every node
+    neighbourCount_ = MIN(neighbourCount, dimension_ - 2);
+    neighbours_.assign((size_t)dimension_ * neighbourCount_, 0);
+    // rank by squared length when the metric is monotone in it, which avoids the
+    // square roots and lets a grid skip the far customers
+    const bool squared = !file.explicitWeights && file.metric != DistanceMatrix::MAN_2D && file.metric != DistanceMatrix::MAX_2D;
+    unique_ptr<Grid> grid(squared && neighbourCount_ > 0 ? new Grid(file.x, file.y) : nullptr);
+    #pragma omp parallel
+    {
+        Nearest nearest;
+        #pragma omp for schedule(dynamic, 64)
+        for (int i = 0; i < dimension_; ++i) {
+            if (grid) grid->nearest(file.x, file.y, i, neighbourCount_, nearest);
+            else {
+                nearest.clear();
+                for (int j = 1; j < dimension_; ++j) {
+                    if (j == i) continue;
+                    double dx = file.x[i] - file.x[j], dy = file.y[i] - file.y[j];
+                    offer(nearest, neighbourCount_, file.explicitWeights ? distance_(i, j) : DistanceMatrix::weight(file.metric, dx, dy), (customer_t)j);
+                }
+                sort_heap(nearest.begin(), nearest.end());
+            }
+            for (int k = 0; k < neighbourCount_; ++k) 
+                neighbours_[(size_t)i * neighbourCount_ + k] = nearest[k].second;
+        }
+    }
+}
+
+shared_ptr<const ProblemInstance> ProblemInstance::load(const char *fileName, int neighbourCount, int tableLimit) {
+    return make_shared<const ProblemInstance>(fileName, neighbourCount, tableLimit);
+}
+
+#endif
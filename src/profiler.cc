@@ -0,0 +1,151 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _PROFILER_CC_
+#define _PROFILER_CC_
+
+#include "profiler.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+string path;
+volatile sig_atomic_t requested = 0;
+
+extern "C" void onSignal(int) {
+    requested = 1;
+}
+
+#ifdef CVRP_PROFILE
+// every slot ever attached, guarded by slotLock
+mutex slotLock;
+vector<Profiler::Slot*> slots;
+
+// the tick rate is measured over the whole run, from static initialization on
+const uint64_t startTicks = Profiler::ticks();
+const chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+#endif
+
+}
+
+#ifdef CVRP_PROFILE
+Profiler::Slot *Profiler::attach() {
+    Slot *slot = new Slot();
+    for (int op = 0; op < OPERATORS; ++op)
+        for (int o = 0; o < OUTCOMES; ++o)
+            slot->counts[op][o].store(0, memory_order_relaxed);
+
+    lock_guard<mutex> guard(slotLock);
+    slots.push_back(slot);
+    return slot;
+}
+#endif
+
+void Profiler::open(const string &file) {
+    if (!enabled) {
+        fprintf(stderr, "built without CVRP_PROFILE, no profile is written\n");
+        return;
+    }
+    path = file;
+#ifdef SIGUSR1
+    signal(SIGUSR1, onSignal);
+#endif
+}
+
+void Profiler::poll() {
+    if (!requested) return;
+    requested = 0;
+    write();
+}
+
+void Profiler::write() {
+#ifdef CVRP_PROFILE
+    if (path.empty()) return;
+
+    // sum the slots, the owners may still be counting
+    uint64_t total[OPERATORS][OUTCOMES] = {};
+    int threads;
+    {
+        lock_guard<mutex> guard(slotLock);
+        threads = slots.size();
+        for (int t = 0; t < threads; ++t)
+            for (int op = 0; op < OPERATORS; ++op)
+                for (int o = 0; o < OUTCOMES; ++o)
+                    total[op][o] += slots[t]->counts[op][o].load(memory_order_relaxed);
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    double rate = (seconds > 0)? (ticks() - startTicks) / seconds : 1;
+    bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+
+    // replace the report atomically, a reader never sees half of it
+    string temp = path + ".tmp";
+    FILE *out = fopen(temp.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "cannot write %s\n", temp.c_str());
+        return;
+    }
+
+    static const char *fields[] = { "attempts", "feasible", "accepted", "improved", "uphill", "cycles" };
+    if (csv) {
+        fprintf(out, "operator");
+        for (int o = 0; o < OUTCOMES; ++o)
+            fprintf(out, ",%s", fields[o]);
+        fprintf(out, ",seconds\n");
+        for (int op = 0; op < OPERATORS; ++op) {
+            fprintf(out, "%s", name((Operator)op));
+            for (int o = 0; o < OUTCOMES; ++o)
+                fprintf(out, ",%llu", (unsigned long long)total[op][o]);
+            fprintf(out, ",%.6f\n", total[op][CYCLES] / rate);
+        }
+    } else {
+        fprintf(out, "{\n  \"threads\": %d,\n  \"seconds\": %.3f,\n  \"ticks_per_second\": %.0f,\n  \"operators\": [\n", threads, seconds, rate);
+        for (int op = 0; op < OPERATORS; ++op) {
+            fprintf(out, "    {\"operator\": \"%s\"", name((Operator)op));
+            for (int o = 0; o < OUTCOMES; ++o)
+                fprintf(out, ", \"%s\": %llu", fields[o], (unsigned long long)total[op][o]);
+            fprintf(out, ", \"seconds\": %.6f}%s\n", total[op][CYCLES] / rate, (op + 1 < OPERATORS)? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+    }
+    fclose(out);
+    rename(temp.c_str(), path.c_str());
+#endif
+}
+
+const char *Profiler::name(Operator op) {
+    switch (op) {
+        case INSERT: return "insert";
+        case INSERT_BACK: return "insert_back";
+        case SWAP: return "swap";
+        case EXCHANGE: return "exchange";
+        case SEGMENT_SWAP: return "segment_swap";
+        case OPT_SWAP: return "opt_swap";
+        case MUTATE: return "mutate";
+        case OPT_MUTATE: return "opt_mutate";
+        case CROSSOVER: return "crossover";
+        case LOCAL_SEARCH: return "local_search";
+        case SELECTION: return "selection";
+        case EVALUATE: return "evaluate";
+        case SORT: return "sort";
+        case MIGRATION: return "migration";
+        case CONSTRUCTION: return "construction";
+        case GENERATION: return "generation";
+        default: return "unknown";
+    }
+}
+
+#endif
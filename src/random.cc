@@ -0,0 +1,70 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _RANDOM_CC_
+#define _RANDOM_CC_
+
+#include "random.h"
+
+#include <omp.h>
+
+using namespace std;
+
+uint64_t Random::seed_ = 0x9e3779b97f4a7c15ULL;
+atomic<unsigned> Random::epoch_(1);
+
+void Xoshiro256::seed(uint64_t seed) {
+    for (int i = 0; i < 4; ++i) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        s_[i] = z ^ (z >> 31);
+    }
+}
+
+void Xoshiro256::jump() {
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; ++i) {
+        for (int b = 0; b < 64; ++b) {
+            if (JUMP[i] & (1ULL << b)) {
+                s0 ^= s_[0];
+                s1 ^= s_[1];
+                s2 ^= s_[2];
+                s3 ^= s_[3];
+            }
+            (*this)();
+        }
+    }
+    s_[0] = s0;
+    s_[1] = s1;
+    s_[2] = s2;
+    s_[3] = s3;
+}
+
+void Random::seed(uint64_t seed) {
+    seed_ = seed;
+    epoch_.fetch_add(1, memory_order_release);
+}
+
+Xoshiro256 &Random::engine() {
+    static thread_local Xoshiro256 generator;
+    static thread_local unsigned epoch = 0;
+
+    unsigned current = epoch_.load(memory_order_acquire);
+    if (epoch != current) {
+        generator.seed(seed_);
+        for (int t = omp_get_thread_num(); t > 0; --t)
+            generator.jump();
+        epoch = current;
+    }
+    return generator;
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _SELECTION_CC_
+#define _SELECTION_CC_
+
+#include "random.h"
+#include "selection.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+void Selection::prepare(const Gene *genes, int n) {
+    size_ = n;
+    if (type_ != ROULETTE || n <= 0) return;
+
+    // linear scaling: the worst gene keeps a share of the spread, so it can
+    // still be drawn, equal costs give a uniform draw
+    double best = genes[0].cost(), worst = genes[0].cost();
+    for (int i = 1; i < n; ++i) {
+        best = min(best, genes[i].cost());
+        worst = max(worst, genes[i].cost());
+    }
+    const double spread = worst - best, floor = (spread > 0)? spread / n : 1;
+
+    probability_.resize(n);
+    alias_.resize(n);
+    double total = 0;
+    for (int i = 0; i < n; ++i)
+        total += worst - genes[i].cost() + floor;
+
+    // Vose's alias method, weights scaled to a mean of 1
+    small_.clear();
+    large_.clear();
+    for (int i = 0; i < n; ++i) {
+        probability_[i] = (worst - genes[i].cost() + floor) * n / total;
+        alias_[i] = i;
+        if (probability_[i] < 1) small_.push_back(i);
+        else large_.push_back(i);
+    }
+    while (!small_.empty() && !large_.empty()) {
+        int s = small_.back(), l = large_.back();
+        small_.pop_back();
+        alias_[s] = l;
+        probability_[l] -= 1 - probability_[s];
+        if (probability_[l] < 1) {
+            large_.pop_back();
+            small_.push_back(l);
+        }
+    }
+    // what is left is 1 up to rounding
+    for (int k = 0; k < small_.size(); ++k)
+        probability_[small_[k]] = 1;
+    for (int k = 0; k < large_.size(); ++k)
+        probability_[large_[k]] = 1;
+}
+
+int Selection::operator()() const {
+    Xoshiro256 &engine = Random::engine();
+    if (type_ == ROULETTE) {
+        int i = engine.below(size_);
+        return (engine.real() < probability_[i])? i : alias_[i];
+    }
+    // the population is sorted, so the lowest index wins
+    int winner = engine.below(size_);
+    for (int k = 1; k < tournamentSize_; ++k)
+        winner = min(winner, (int)engine.below(size_));
+    return winner;
+}
+
+void Selection::pair(int &p, int &q) const {
+    p = (*this)();
+    do q = (*this)();
+    while (q == p);
+}
+
+bool Selection::parse(const string &name, Type &type) {
+    if (name == "roulette") type = ROULETTE;
+    else if (name == "tournament") type = TOURNAMENT;
+    else return false;
+    return true;
+}
+
+const char *Selection::name(Type type) {
+    switch (type) {
+        case TOURNAMENT: return "tournament";
+        default: return "roulette";
+    }
+}
+
+#endif
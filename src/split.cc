@@ -0,0 +1,123 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _SPLIT_CC_
+#define _SPLIT_CC_
+
+#include "kernels.h"
+#include "split.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#define EPSILON 1e-9
+
+using namespace std;
+
+namespace {
+
+// per-thread arrays indexed by tour position, 1-based as in the paper,
+// shaped like the local search, see Kernels
+template <typename Index, typename Lookup, int MaxDimension>
+struct Split {
+    typedef Lookup Distances;
+    typedef typename Lookup::Cost Cost;
+    static const size_t SIZE = MaxDimension? MaxDimension + 1 : 0;
+
+    // prefix load, prefix distance along the tour, depot distances
+    Buffer<long, SIZE> load;
+    Buffer<Cost, SIZE> distance, depot;
+    // shortest path to every position and its predecessor
+    Buffer<Cost, SIZE> potential;
+    Buffer<Index, SIZE> pred, queue;
+
+    void reserve(int n) {
+        load.resize(n + 2);
+        distance.resize(n + 2);
+        depot.resize(n + 2);
+        potential.resize(n + 1);
+        pred.resize(n + 1);
+        queue.resize(n + 1);
+    }
+};
+
+// on the heap since the fixed arrays are large
+template <class S>
+S &scratch() {
+    static thread_local unique_ptr<S> s;
+    if (!s) s.reset(new S());
+    return *s;
+}
+
+template <class S>
+double solve(const ProblemInstance &instance, const Node *tour, int n, vector<int> &ends) {
+    typedef typename S::Cost Cost;
+    S &s = scratch<S>();
+    s.reserve(n);
+    const long capacity = instance.capacity();
+    const typename S::Distances distance(instance);
+    // a tie within EPSILON, or an exact one for integer costs
+    const Cost tolerance = numeric_limits<Cost>::is_integer? 1 : EPSILON;
+
+    s.load[0] = 0;
+    s.distance[0] = s.distance[1] = 0;
+    s.depot[0] = s.depot[n + 1] = 0;
+    for (int i = 1; i <= n; ++i) {
+        customer_t c = tour[i - 1].index();
+        s.load[i] = s.load[i - 1] + instance.demand(c);
+        s.depot[i] = distance(0, c);
+        if (i > 1) s.distance[i] = s.distance[i - 1] + distance(tour[i - 2].index(), c);
+    }
+    s.load[n + 1] = s.load[n];
+    s.distance[n + 1] = s.distance[n];
+
+    // cost of reaching j with a route that starts after i
+    auto propagate = [&](int i, int j) { return s.potential[i] + s.depot[i + 1] + s.distance[j] - s.distance[i + 1] + s.depot[j]; };
+    // key that orders the predecessors kept in the queue
+    auto key = [&](int i) { return s.potential[i] + s.depot[i + 1] - s.distance[i + 1]; };
+
+    s.potential[0] = 0;
+    int front = 0, back = 0;
+    s.queue[0] = 0;
+    for (int t = 1; t <= n; ++t) {
+        s.potential[t] = propagate(s.queue[front], t);
+        s.pred[t] = s.queue[front];
+
+        if (t < n) {
+            // the back dominates t only with the same load and a better key
+            int last = s.queue[back];
+            if (!(s.load[last] == s.load[t] && key(last) <= key(t))) {
+                while (back >= front && key(t) < key(s.queue[back]) + tolerance) --back;
+                s.queue[++back] = t;
+            }
+            while (front < back && s.load[t + 1] - s.load[s.queue[front]] > capacity) ++front;
+        }
+    }
+
+    // routes from the back, then reversed into tour order
+    ends.clear();
+    for (int t = n; t > 0; t = s.pred[t]) ends.push_back(t);
+    reverse(ends.begin(), ends.end());
+
+    return s.potential[n];
+}
+
+}
+
+double split(const ProblemInstance &instance, const Node *tour, int n, vector<int> &ends) {
+    switch (Kernels::shape(instance)) {
+        case Kernels::SMALL_INTEGER: return solve< Split<uint16_t, IntegerLookup, Kernels::SMALL_DIMENSION> >(instance, tour, n, ends);
+        case Kernels::SMALL: return solve< Split<uint16_t, SquareLookup, Kernels::SMALL_DIMENSION> >(instance, tour, n, ends);
+        case Kernels::NARROW: return solve< Split<uint16_t, InstanceLookup, 0> >(instance, tour, n, ends);
+        default: return solve< Split<uint32_t, InstanceLookup, 0> >(instance, tour, n, ends);
+    }
+}
+
+#endif
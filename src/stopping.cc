@@ -0,0 +1,59 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _STOPPING_CC_
+#define _STOPPING_CC_
+
+#include "stopping.h"
+
+#include <limits>
+
+using namespace std;
+using namespace std::chrono;
+
+Incumbent::Incumbent(): time_(0), cost_(numeric_limits<double>::infinity()), stop_(false), start_(steady_clock::now()) {}
+
+void Incumbent::start() {
+    lock_guard<mutex> guard(lock_);
+    gene_ = Gene();
+    time_ = 0;
+    cost_.store(numeric_limits<double>::infinity(), memory_order_relaxed);
+    stop_.store(false, memory_order_relaxed);
+    start_ = steady_clock::now();
+}
+
+double Incumbent::elapsed() const {
+    return duration_cast< duration<double> >(steady_clock::now() - start_).count();
+}
+
+bool Incumbent::offer(const Gene &gene) {
+    // most generations do not improve, skip the lock for them
+    if (gene.cost() >= cost()) return false;
+    
+    lock_guard<mutex> guard(lock_);
+    if (gene.cost() >= cost()) return false;
+    
+    gene_ = gene;
+    time_ = elapsed();
+    cost_.store(gene.cost(), memory_order_relaxed);
+    if (callback_) callback_(gene_, time_);
+    return true;
+}
+
+Gene Incumbent::get(double *time) const {
+    lock_guard<mutex> guard(lock_);
+    if (time) *time = time_;
+    return gene_;
+}
+
+void Incumbent::setCallback(Callback callback) {
+    lock_guard<mutex> guard(lock_);
+    callback_ = callback;
+}
+
+#endif
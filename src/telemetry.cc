@@ -0,0 +1,92 @@
+/*********************************
+ *  ___      __      ___        *
+ *  \  \    /  \    /  /       *
+ *   \  \  / __ \  /  /  **     *
+ *    \  \/ /  \ \/  /  *  *     *
+ *     \   /    \   /  * ** *   *
+ *      ---      ---   wngfra    *
+ * ******************************/
+#ifndef _TELEMETRY_CC_
+#define _TELEMETRY_CC_
+
+#include "telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+using namespace std;
+
+const size_t Telemetry::RING_SIZE;
+const size_t Telemetry::BLOCK_SIZE;
+
+Telemetry::Telemetry(const string &csvPath, Sampling sampling, int every, const string &binaryPath, bool echo): ring_(RING_SIZE), sampling_(sampling), every_(every > 0 ? every : 1), echo_(echo), lastCost_(numeric_limits<double>::infinity()), running_(true) {
+    csv_.open(csvPath.c_str(), ios::out);
+    csv_ << "generation,best_cost,temperature,solution_counter\n";
+    
+    if (!binaryPath.empty()) {
+        binary_.open(binaryPath.c_str(), ios::out | ios::binary);
+        binary_.write("CVRPEVO1", 8);
+        block_.reserve(BLOCK_SIZE);
+    }
+    
+    writer_ = thread(&Telemetry::write, this);
+}
+
+Telemetry::~Telemetry() {
+    running_.store(false, memory_order_release);
+    writer_.join();
+}
+
+void Telemetry::record(int generation, double bestCost, double temperature, int solutionCounter) {
+    if (sampling_ == IMPROVEMENT) {
+        if (bestCost >= lastCost_) return;
+        lastCost_ = bestCost;
+    } else if (generation % every_ != 0) return;
+    
+    EvolutionRecord record = { generation, solutionCounter, bestCost, temperature };
+    // the writer is far behind, wait for room rather than drop samples
+    while (!ring_.push(record)) 
+        this_thread::yield();
+}
+
+void Telemetry::write() {
+    EvolutionRecord record;
+    
+    for (;;) {
+        // read the flag first so nothing pushed before shutdown is missed
+        bool running = running_.load(memory_order_acquire);
+        bool drained = true;
+        
+        while (ring_.pop(record)) {
+            drained = false;
+            csv_ << record.generation << "," << record.bestCost << "," << record.temperature << "," << record.solutionCounter << "\n";
+            if (echo_) printf("generation %d temperature: %.3f, cost: %.3f\n", record.generation, record.temperature, record.bestCost);
+            if (binary_.is_open()) {
+                block_.push_back(record);
+                if (block_.size() == BLOCK_SIZE) flushBlock();
+            }
+        }
+        
+        if (!running) break;
+        if (drained) this_thread::sleep_for(chrono::milliseconds(20));
+    }
+    
+    if (binary_.is_open()) flushBlock();
+    csv_.flush();
+    fflush(stdout);
+}
+
+void Telemetry::flushBlock() {
+    uint32_t count = block_.size();
+    if (count == 0) return;
+    
+    binary_.write((const char*)&count, sizeof(count));
+    for (uint32_t i = 0; i < count; ++i) binary_.write((const char*)&block_[i].generation, sizeof(int32_t));
+    for (uint32_t i = 0; i < count; ++i) binary_.write((const char*)&block_[i].bestCost, sizeof(double));
+    for (uint32_t i = 0; i < count; ++i) binary_.write((const char*)&block_[i].temperature, sizeof(double));
+    for (uint32_t i = 0; i < count; ++i) binary_.write((const char*)&block_[i].solutionCounter, sizeof(int32_t));
+    block_.clear();
+}
+
+#endif
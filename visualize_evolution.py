@@ -12,6 +12,33 @@ import numpy as np
 import sys
 import os
 
+def read_evolution_data(path):
+    """
+    Read evolution data written by the solver.
+
+    Accepts the CSV file or the binary columnar file (--binary): the magic
+    b'CVRPEVO1' followed by blocks of a uint32 count and the generation,
+    best cost, temperature and solution counter columns.
+    """
+    if not path.endswith('.bin'):
+        return pd.read_csv(path)
+
+    columns = {'generation': [], 'best_cost': [], 'temperature': [], 'solution_counter': []}
+    with open(path, 'rb') as f:
+        if f.read(8) != b'CVRPEVO1':
+            raise ValueError(f"{path} is not a CVRP evolution file")
+        while True:
+            head = f.read(4)
+            if len(head) < 4:
+                break
+            count = int(np.frombuffer(head, dtype='<u4')[0])
+            columns['generation'].append(np.frombuffer(f.read(4 * count), dtype='<i4'))
+            columns['best_cost'].append(np.frombuffer(f.read(8 * count), dtype='<f8'))
+            columns['temperature'].append(np.frombuffer(f.read(8 * count), dtype='<f8'))
+            columns['solution_counter'].append(np.frombuffer(f.read(4 * count), dtype='<i4'))
+    return pd.DataFrame({k: np.concatenate(v) if v else np.array([]) for k, v in columns.items()})
+
+
 def create_evolution_plots(csv_file='evolution_data.csv', output_file='evolution_progress.png', animate=False):
     """
     Create visualization of the genetic algorithm evolution process.
@@ -27,7 +54,7 @@ def create_evolution_plots(csv_file='evolution_data.csv', output_file='evolution
         return
 
     # Read evolution data
-    data = pd.read_csv(csv_file)
+    data = read_evolution_data(csv_file)
 
     # Create figure with custom style
     plt.style.use('seaborn-v0_8-darkgrid' if 'seaborn-v0_8-darkgrid' in plt.style.available else 'default')
@@ -174,5 +201,7 @@ if __name__ == '__main__':
     if len(sys.argv) > 1 and sys.argv[1] == '--animate':
         print("Starting real-time animation...")
         animate_evolution()
+    elif len(sys.argv) > 1:
+        create_evolution_plots(csv_file=sys.argv[1])
     else:
         create_evolution_plots()